@@ -6,18 +6,31 @@
 #include "../General/SimilaritySearch.h"
 #include "HSW.h"
 
+//High scoring word index of a query
+struct HSWIndex : QueryState
+{
+	std::unordered_map<std::string, std::vector<HSW>> index;
+};
+
 class BLAST : public SimilaritySearch
 {
+	friend class KernelBenchmark; //Micro-benchmarks of the private kernels
 private:
 	int T;
 	int A;
 	int X;
 	int q;
 	int substitutionMatrix[53][53];
-	std::unordered_map<std::string, std::vector<HSW>> GenerateHSWIndex(std::string query);
-	void UngappedExtension(int qpos, int epos, std::string query, std::string entry, int& score, int& ql, int& qr, int& el, int& er);
+	std::unordered_map<std::string, std::vector<HSW>> GenerateHSWIndex(std::string_view query);
+	void UngappedExtension(int qpos, int epos, std::string_view query, std::string_view entry, int& score, int& ql, int& qr, int& el, int& er);
+	double ScoreEntry(std::string_view query, const std::unordered_map<std::string, std::vector<HSW>>& indexHSW, std::string_view entry, bool& significant);
+protected:
+	bool Scans() override { return true; }
+	bool LowerIsBetter() override { return false; }
+	std::unique_ptr<QueryState> Prepare(std::string_view query) override;
+	void ScanShard(const std::vector<std::string_view>& queries, const std::vector<const QueryState*>& states, int begin, int end, std::vector<TopK>& tops) override;
 public:
 	BLAST() {}
-	BLAST(Database* db, int T, int A, int X, int q);
-	std::vector<Result> SearchSequence(std::string query) override;
+	BLAST(const Database* db, int T, int A, int X, int q);
+	const char* Name() override { return "BLAST"; }
 };
\ No newline at end of file
@@ -0,0 +1,464 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "Benchmark.h"
+#include "../General/Memory.h"
+#include "../General/Metrics.h"
+#include "../BLAST/BLAST.h"
+#include "../ED/ED.h"
+#include "../GA/GA.h"
+#include "../LA/LA.h"
+#include "../PassJoin/PassJoin.h"
+#include "../PIVOTAL/PivotalSearch.h"
+#include "../SSMAW/SSMAW.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+std::vector<GroundTruth> QueryList(std::string name)
+{
+	std::vector<GroundTruth> list;
+	std::fstream file;
+	file.open(name, std::ios::in);
+	if (file.is_open())
+	{
+		std::string line;
+		while (std::getline(file, line))
+		{
+			//Lines "query\tresult\t...", lines without a result are skipped
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			size_t j = line.find('\t');
+			if (j == std::string::npos)
+				continue;
+			size_t j2 = line.find('\t', j + 1);
+			std::string query = line.substr(0, j);
+			std::string result = line.substr(j + 1, (j2 == std::string::npos) ? std::string::npos : j2 - (j + 1));
+			if (query.empty() || result.empty())
+				continue;
+			list.push_back(GroundTruth(query, result));
+		}
+	}
+	return list;
+}
+
+std::vector<GroundTruth> PairsInDatabase(const std::vector<GroundTruth>& list, const Database* db)
+{
+	//Absent queries would be timed as empty searches and absent results count as misses, e.g. on a subset of the database
+	std::vector<GroundTruth> present;
+	for (const GroundTruth& truth : list)
+		if (db->Find(truth.query) >= 0 && db->Find(truth.result) >= 0)
+			present.push_back(truth);
+	return present;
+}
+
+std::string DatabaseFile(std::string name)
+{
+	//Binary database (mode 4) if it exists, text file otherwise
+	std::ifstream binary(name + ".db", std::ios::binary);
+	if (binary.is_open())
+		return name + ".db";
+	return name + ".txt";
+}
+
+//Configuration
+std::string Trim(std::string value)
+{
+	//Without surrounding whitespace, names may contain spaces
+	size_t begin = value.find_first_not_of(" \t\r");
+	if (begin == std::string::npos)
+		return "";
+	return value.substr(begin, value.find_last_not_of(" \t\r") - begin + 1);
+}
+
+std::vector<std::string> SplitList(std::string value)
+{
+	std::vector<std::string> list;
+	std::stringstream stream(value);
+	std::string item;
+	while (std::getline(stream, item, ','))
+		if (!Trim(item).empty())
+			list.push_back(Trim(item));
+	return list;
+}
+
+bool ParseNumber(std::string text, int& number)
+{
+	//Whole text, false for anything else than an int
+	try
+	{
+		size_t end;
+		int parsed = std::stoi(text, &end);
+		if (end != text.size())
+			return false;
+		number = parsed;
+		return true;
+	}
+	catch (const std::logic_error&) //std::invalid_argument, std::out_of_range
+	{
+		return false;
+	}
+}
+
+bool ParseNumbers(std::string text, std::vector<int>& numbers)
+{
+	std::vector<int> parsed;
+	for (std::string number : SplitList(text))
+	{
+		parsed.push_back(0);
+		if (!ParseNumber(number, parsed.back()))
+			return false;
+	}
+	numbers = parsed;
+	return true;
+}
+
+bool BenchmarkConfig::Set(std::string key, std::string value)
+{
+	if (key == "algorithms")
+		algorithms = SplitList(value);
+	else if (key == "databases")
+		databases = SplitList(value);
+	else if (key == "queries")
+		queryLists = SplitList(value);
+	else if (key == "output")
+		output = value;
+	else if (key == "mode")
+		mode = value;
+	else if (key == "metrics")
+		metrics = value;
+	else if (key == "trace")
+		trace = value;
+	else if (key == "negatives")
+		negatives = value;
+	else if (key.size() > 5 && key.compare(0, 5, "sweep") == 0)
+	{
+		BenchmarkConfig known; //Only existing settings can be swept
+		if (!known.Set(key.substr(5), "0"))
+			return false;
+		std::vector<int> values;
+		if (!ParseNumbers(value, values))
+			return false;
+		sweeps[key.substr(5)] = values;
+	}
+	else if (key == "distributions")
+		distributions = SplitList(value);
+	else if (key == "baseline")
+		baseline = value;
+	else if (key == "lengths" || key == "thresholds" || key == "threads")
+	{
+		std::vector<int>& numbers = (key == "lengths") ? lengths : (key == "thresholds") ? thresholds : threads;
+		if (!ParseNumbers(value, numbers))
+			return false;
+	}
+	else
+	{
+		int* setting = nullptr;
+		std::vector<std::pair<std::string, int*>> numbers = { { "k", &k }, { "MAWmin", &MAWmin }, { "MAWmax", &MAWmax }, { "MAWbands", &MAWbands }, { "MAWrows", &MAWrows },
+			{ "MAWprobe", &MAWprobe }, { "BLT", &BLT }, { "BLA", &BLA }, { "BLX", &BLX }, { "BLq", &BLq }, { "EDthreshold", &EDthreshold }, { "PASSchain", &PASSchain },
+			{ "PIVq", &PIVq }, { "PIVchain", &PIVchain }, { "concurrency", &concurrency }, { "warmRuns", &warmRuns }, { "counters", &counters },
+			{ "saveBaseline", &saveBaseline }, { "tolerance", &tolerance }, { "minTime", &minTime }, { "collapse", &collapse },
+			{ "entries", &entries }, { "duplicates", &duplicates }, { "distance", &distance }, { "seed", &seed }, { "binary", &binary },
+			{ "samples", &samples }, { "targetRecall", &targetRecall } };
+		for (auto& number : numbers)
+			if (number.first == key)
+				setting = number.second;
+		if (setting == nullptr || !ParseNumber(value, *setting))
+			return false;
+	}
+	return true;
+}
+
+bool BenchmarkConfig::Read(std::string name)
+{
+	std::ifstream file(name);
+	if (!file.is_open())
+		return false;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		line = Trim(line.substr(0, line.find('#')));
+		if (line.empty())
+			continue;
+		size_t pos = line.find('=');
+		if (pos == std::string::npos || !Set(Trim(line.substr(0, pos)), Trim(line.substr(pos + 1))))
+			std::cout << "Unknown or invalid setting: " << line << "\n";
+	}
+	return true;
+}
+
+SimilaritySearch* CreateEngine(std::string algorithm, const Database* db, const BenchmarkConfig& config)
+{
+	if (algorithm == "SSMAW")
+	{
+		SSMAW* engine = new SSMAW(db, config.MAWmin, config.MAWmax, config.MAWbands, config.MAWrows);
+		engine->SetProbeBands(config.MAWprobe);
+		return engine;
+	}
+	if (algorithm == "ED")
+		return new ED(db);
+	if (algorithm == "GA")
+		return new GA(db);
+	if (algorithm == "LA")
+		return new LA(db);
+	if (algorithm == "BLAST")
+		return new BLAST(db, config.BLT, config.BLA, config.BLX, config.BLq);
+	if (algorithm == "PassJoin")
+		return new PassJoin(db, config.EDthreshold, config.PASSchain);
+	if (algorithm == "PIVOTAL")
+		return new PivotalSearch(db, config.PIVq, config.EDthreshold, config.PIVchain);
+	return nullptr;
+}
+
+//Latency
+std::string LatencyReport::Header()
+{
+	std::string header;
+	for (std::string run : { "Cold", "Warm" })
+		for (std::string column : { "mean (ms)", "p50 (ms)", "p90 (ms)", "p99 (ms)", "max (ms)", "QPS" })
+			header += run + " " + column + ";";
+	return header;
+}
+
+std::string LatencyReport::Line() const
+{
+	std::string line;
+	for (const Histogram* histogram : { &cold, &warm })
+	{
+		line += std::to_string(histogram->Mean() / 1000000) + ";";
+		for (double p : { 50.0, 90.0, 99.0 })
+			line += std::to_string(histogram->Percentile(p) / 1000000.0) + ";";
+		line += std::to_string(histogram->Max() / 1000000.0) + ";";
+		line += std::to_string(histogram == &cold ? ColdQPS() : WarmQPS()) + ";";
+	}
+	return line;
+}
+
+double LatencyRun(SimilaritySearch* engine, const std::vector<std::string_view>& queries, int k, int concurrency, Histogram& histogram)
+{
+	//Every client records into its own histogram, merged afterwards
+	std::vector<Histogram> local(concurrency);
+	std::atomic<int> next(0);
+	auto client = [&](int c)
+	{
+		int i;
+		while ((i = next++) < queries.size())
+		{
+			long long start = Metrics::Now();
+			engine->SearchSequence(queries[i], k);
+			local[c].Record(Metrics::Now() - start);
+		}
+	};
+	long long start = Metrics::Now();
+	std::vector<std::thread> clients;
+	for (int c = 1; c < concurrency; c++)
+		clients.push_back(std::thread(client, c));
+	client(0);
+	for (std::thread& thread : clients)
+		thread.join();
+	double duration = (Metrics::Now() - start) / 1000000.0;
+	for (const Histogram& h : local)
+		histogram.Merge(h);
+	return duration;
+}
+
+LatencyReport MeasureLatency(SimilaritySearch* engine, const std::vector<std::string>& queryIDs, int k, int concurrency, int warmRuns)
+{
+	std::vector<std::string_view> queries;
+	for (const std::string& queryID : queryIDs)
+	{
+		int id = engine->db->Find(queryID);
+		if (id >= 0)
+			queries.push_back(engine->db->Sequence(engine->db->Get(id)));
+	}
+	concurrency = std::max(concurrency, 1);
+	LatencyReport report;
+	report.skipped = (int)(queryIDs.size() - queries.size());
+	report.coldTime = LatencyRun(engine, queries, k, concurrency, report.cold);
+	for (int run = 0; run < warmRuns; run++)
+		report.warmTime += LatencyRun(engine, queries, k, concurrency, report.warm);
+	return report;
+}
+
+//Running
+struct BenchmarkRun
+{
+	std::string database;
+	std::string algorithm;
+	std::string queryList;
+	int entries;
+	int queries;
+	double loadTime; //ms
+	double indexTime; //ms
+	long long indexMemory; //Bytes, resident memory added by building the index
+	MemoryReport structures; //Bytes per structure (SimilaritySearch::Memory)
+	double searchTime; //ms, whole batch
+	LatencyReport latency;
+	double truthFound; //Fraction of queries with the ground truth in the top k
+	long long peakMemory; //Bytes
+	std::vector<Counters::Total> counters; //Per phase: index construction (with the first query list) and searches of the run
+};
+
+std::string JSONString(std::string value)
+{
+	std::string escaped = "\"";
+	for (char c : value)
+	{
+		if (c == '"' || c == '\\')
+			escaped += '\\';
+		escaped += c;
+	}
+	return escaped + "\"";
+}
+
+std::string JSONLatency(const Histogram& histogram, double qps)
+{
+	std::ostringstream json;
+	json << "{ \"queries\": " << histogram.Count() << ", \"meanMs\": " << histogram.Mean() / 1000000 << ", \"p50Ms\": " << histogram.Percentile(50) / 1000000.0
+		<< ", \"p90Ms\": " << histogram.Percentile(90) / 1000000.0 << ", \"p99Ms\": " << histogram.Percentile(99) / 1000000.0
+		<< ", \"maxMs\": " << histogram.Max() / 1000000.0 << ", \"qps\": " << qps << " }";
+	return json.str();
+}
+
+std::string JSONMemory(const MemoryReport& report)
+{
+	std::ostringstream json;
+	json << "{ ";
+	for (const auto& structure : report.structures)
+		json << JSONString(structure.first) << ": " << structure.second << ", ";
+	json << "\"Total\": " << report.Total() << " }";
+	return json.str();
+}
+
+std::string JSONCounters(const std::vector<Counters::Total>& totals)
+{
+	//Phase -> events, unavailable events left out
+	std::ostringstream json;
+	json << "{";
+	for (int i = 0; i < totals.size(); i++)
+	{
+		json << (i == 0 ? " " : ", ") << JSONString(Metrics::Name((Metrics::Phase)totals[i].phase)) << ": { \"spans\": " << totals[i].spans;
+		for (int e = 0; e < Counters::EVENTS; e++)
+			if (totals[i].value[e] >= 0)
+				json << ", " << JSONString(Counters::Name((Counters::Event)e)) << ": " << totals[i].value[e];
+		json << " }";
+	}
+	json << " }";
+	return json.str();
+}
+
+void WriteResults(const BenchmarkConfig& config, const std::vector<BenchmarkRun>& runs)
+{
+	std::ofstream csv(config.output + ".csv");
+	csv << "Database;Algorithm;Query list;Entries;Queries;k;Load time (ms);Index time (ms);Index memory (bytes);Search time (ms);Mean query time (ms);Queries per second;Truth found;Peak memory (bytes);Concurrency;" << LatencyReport::Header() << "\n";
+	for (const BenchmarkRun& run : runs)
+	{
+		csv << run.database << ";" << run.algorithm << ";" << run.queryList << ";" << run.entries << ";" << run.queries << ";" << config.k << ";"
+			<< run.loadTime << ";" << run.indexTime << ";" << run.indexMemory << ";" << run.searchTime << ";" << run.searchTime / std::max(run.queries, 1) << ";"
+			<< run.queries / std::max(run.searchTime / 1000, 1e-9) << ";" << run.truthFound << ";" << run.peakMemory << ";" << config.concurrency << ";" << run.latency.Line() << "\n";
+	}
+	std::ofstream json(config.output + ".json");
+	json << "{\n\t\"k\": " << config.k << ",\n\t\"concurrency\": " << config.concurrency << ",\n\t\"warmRuns\": " << config.warmRuns << ",\n\t\"runs\": [";
+	for (int i = 0; i < runs.size(); i++)
+	{
+		const BenchmarkRun& run = runs[i];
+		json << (i == 0 ? "\n" : ",\n") << "\t\t{ \"database\": " << JSONString(run.database) << ", \"algorithm\": " << JSONString(run.algorithm)
+			<< ", \"queryList\": " << JSONString(run.queryList) << ", \"entries\": " << run.entries << ", \"queries\": " << run.queries
+			<< ", \"loadTimeMs\": " << run.loadTime << ", \"indexTimeMs\": " << run.indexTime << ", \"indexMemoryBytes\": " << run.indexMemory
+			<< ", \"searchTimeMs\": " << run.searchTime << ", \"truthFound\": " << run.truthFound << ", \"peakMemoryBytes\": " << run.peakMemory
+			<< ", \"memory\": " << JSONMemory(run.structures) << ", \"counters\": " << JSONCounters(run.counters) << ", \"cold\": " << JSONLatency(run.latency.cold, run.latency.ColdQPS()) << ", \"warm\": " << JSONLatency(run.latency.warm, run.latency.WarmQPS()) << " }";
+	}
+	json << "\n\t]\n}\n";
+	if (config.counters)
+	{
+		std::ofstream counters(config.output + " counters.csv");
+		counters << "Database;Query list;" << Counters::Header() << "\n";
+		for (const BenchmarkRun& run : runs)
+			for (const Counters::Total& total : run.counters)
+				counters << run.database << ";" << run.queryList << ";" << Counters::Line(total) << "\n";
+	}
+	std::ofstream memory(config.output + " memory.csv");
+	memory << "Database;Algorithm;Structure;Bytes;\n";
+	for (int i = 0; i < runs.size(); i++)
+	{
+		//Once per engine
+		const BenchmarkRun& run = runs[i];
+		if (i > 0 && runs[i - 1].database == run.database && runs[i - 1].algorithm == run.algorithm)
+			continue;
+		for (const auto& structure : run.structures.structures)
+			memory << run.database << ";" << run.algorithm << ";" << structure.first << ";" << structure.second << ";\n";
+		memory << run.database << ";" << run.algorithm << ";Total;" << run.structures.Total() << ";\n";
+	}
+}
+
+bool RunBenchmark(const BenchmarkConfig& config)
+{
+	std::vector<BenchmarkRun> runs;
+	if (config.counters && !Counters::Enable())
+		std::cout << "Performance counters are not available (perf_event_open, see /proc/sys/kernel/perf_event_paranoid)\n";
+	for (int e = 0; e < Counters::EVENTS && Counters::Enabled(); e++)
+		if (!Counters::Available((Counters::Event)e))
+			std::cout << "Performance counter not available: " << Counters::Name((Counters::Event)e) << "\n";
+	for (std::string name : config.databases)
+	{
+		long long start = Metrics::Now();
+		Database* database = new Database(name.find('.') == std::string::npos ? DatabaseFile(name) : name);
+		double loadTime = (Metrics::Now() - start) / 1000000.0;
+		if (database->Size() == 0)
+		{
+			std::cout << "Could not load database " << name << "\n";
+			delete database;
+			continue;
+		}
+		for (std::string algorithm : config.algorithms)
+		{
+			long long memory = CurrentMemory();
+			Counters::Reset();
+			start = Metrics::Now();
+			SimilaritySearch* engine = CreateEngine(algorithm, database, config);
+			if (engine == nullptr)
+			{
+				std::cout << "Unknown algorithm " << algorithm << "\n";
+				continue;
+			}
+			double indexTime = (Metrics::Now() - start) / 1000000.0;
+			long long indexMemory = CurrentMemory() - memory;
+			MemoryReport structures = engine->Memory();
+			for (std::string listName : config.queryLists)
+			{
+				std::vector<GroundTruth> all = QueryList(listName);
+				std::vector<GroundTruth> list = PairsInDatabase(all, database);
+				if (list.size() < all.size())
+					std::cout << all.size() - list.size() << " pairs of " << listName << " not in " << name << ", not used\n";
+				std::vector<std::string> queries;
+				for (const GroundTruth& truth : list)
+					queries.push_back(truth.query);
+				std::cout << "Running " << algorithm << " on " << name << " (" << database->Size() << " entries), " << listName << " (" << queries.size() << " queries)\n";
+				LatencyReport latency = MeasureLatency(engine, queries, config.k, config.concurrency, config.warmRuns); //Before the batch, which would warm the caches
+				start = Metrics::Now();
+				std::vector<std::vector<Result>> results = engine->SearchBatchID(queries, config.k);
+				double searchTime = (Metrics::Now() - start) / 1000000.0;
+				int found = 0;
+				for (int i = 0; i < list.size(); i++)
+				{
+					int truth = database->Find(list[i].result);
+					if (std::any_of(results[i].begin(), results[i].end(), [truth](const Result& r) { return r.id == truth; }))
+						found++;
+				}
+				runs.push_back({ name, algorithm, listName, database->Size(), (int)queries.size(), loadTime, indexTime, indexMemory,
+					structures, searchTime, latency, list.empty() ? 0 : (double)found / list.size(), PeakMemory(), Counters::Totals() });
+				Counters::Reset();
+			}
+			delete engine;
+		}
+		delete database;
+	}
+	Counters::Disable();
+	WriteResults(config, runs);
+	return !runs.empty();
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include "../General/Histogram.h"
+#include "../General/SimilaritySearch.h"
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+struct GroundTruth
+{
+	std::string query;
+	std::string result;
+	GroundTruth() {};
+	GroundTruth(std::string query, std::string result)
+	{
+		this->query = query;
+		this->result = result;
+	}
+};
+
+std::vector<GroundTruth> QueryList(std::string name); //Lines "query<TAB>result<TAB>..."
+std::vector<GroundTruth> PairsInDatabase(const std::vector<GroundTruth>& list, const Database* db); //Pairs whose query and result are both entries of db
+std::string DatabaseFile(std::string name); //name.db if it exists, name.txt otherwise
+
+//Headless benchmark: every algorithm on every database with every query list, settings as key=value
+struct BenchmarkConfig
+{
+	std::vector<std::string> algorithms = { "SSMAW", "ED", "GA", "LA", "BLAST", "PassJoin", "PIVOTAL" };
+	std::vector<std::string> databases = { "emo" }; //Without extension -> DatabaseFile
+	std::vector<std::string> queryLists = { "duplicates.txt" };
+	std::string output = "Benchmark"; //Output.json and Output.csv
+	std::string mode = "search"; //search: engines on databases, kernels: micro-benchmarks of the kernels on the first database (Kernels.h), scaling: threads x databases (Scaling.h), generate: synthetic corpus (Generator.h), pareto: accuracy against latency over parameter sweeps (Pareto.h), tune: settings of the filter-based engines (Tuner.h), selftest: consistency checks (SelfTest.h)
+	int k = 100;
+	int MAWmin = 4;
+	int MAWmax = 8;
+	int MAWbands = 0; //LSH bands, 0 = exact search
+	int MAWrows = 0;
+	int MAWprobe = 0; //Probed bands
+	int BLT = 4;
+	int BLA = 10;
+	int BLX = 4;
+	int BLq = 4;
+	int EDthreshold = 6;
+	int PASSchain = 2;
+	int PIVq = 3;
+	int PIVchain = 2;
+	int concurrency = 1; //Clients sending single queries in the latency runs
+	int warmRuns = 2; //Latency runs after the first (cold) one
+	int counters = 0; //1: hardware performance counters per engine and phase (Counters.h)
+	std::string metrics; //Per phase spans and totals (Metrics.h), empty = not recorded
+	std::string trace; //Chrome trace of the index construction and query phases per thread (Metrics.h), empty = no trace
+	//Kernels
+	std::vector<int> lengths = { 32, 128, 512, 2048 };
+	std::vector<int> thresholds = { 2, 6, 16 };
+	std::vector<std::string> distributions = { "real", "uniform", "skewed" };
+	std::string baseline = "Kernels baseline.csv";
+	int saveBaseline = 0; //1: store the measured numbers as the new baseline
+	int tolerance = 10; //Percentage below the baseline before a kernel is flagged
+	int minTime = 200; //ms per measurement
+	//Scaling
+	std::vector<int> threads; //Empty: 1, 2, 4, ... up to the number of hardware threads
+	int collapse = 50; //Scaling efficiency (percentage) below which an engine is flagged
+	//Generator
+	int entries = 100000; //Entries of the generated corpus, planted duplicates included
+	int duplicates = 1000; //Near-duplicates of generated entries
+	int distance = 5; //Edits per near-duplicate
+	int seed = 2021;
+	int binary = 0; //1: also save the corpus as a binary database
+	//Pareto
+	std::map<std::string, std::vector<int>> sweeps = { { "MAWmin", { 3, 4, 5 } }, { "MAWmax", { 6, 8, 10 } }, { "BLT", { 3, 4, 5 } }, { "BLq", { 3, 4 } },
+		{ "EDthreshold", { 4, 6, 8 } }, { "PASSchain", { 2, 3 } }, { "PIVq", { 2, 3, 4 } }, { "PIVchain", { 2, 3 } } }; //sweep<Setting>=values, settings without values keep their value
+	std::string negatives = "not_music.txt"; //Pairs that should not be found
+	//Tuner
+	int samples = 200; //Database entries sampled as queries for the cost estimate
+	int targetRecall = 95; //Percentage of the ground truth pairs found in the top k, on every query list
+	bool Set(std::string key, std::string value); //False for unknown keys and values that are not numbers where numbers are expected, the setting is unchanged
+	bool Read(std::string name); //File with key=value lines, # starts a comment. Lists are comma separated
+};
+
+//Per query wall latency: the first run after building the index is cold, the following runs are warm
+//With concurrent clients, the query of a scanning engine that finds the scheduler pool busy scans on its client thread instead of waiting for the pool:
+//latencies include the contention for the cores, not queueing behind other queries
+struct LatencyReport
+{
+	Histogram cold; //Nanoseconds
+	Histogram warm;
+	double coldTime = 0; //ms, wall time of the cold run
+	double warmTime = 0; //ms, wall time of all warm runs
+	int skipped = 0; //Query IDs not in the database, not timed
+	double ColdQPS() const { return cold.Count() / std::max(coldTime / 1000, 1e-9); }
+	double WarmQPS() const { return warm.Count() / std::max(warmTime / 1000, 1e-9); }
+	static std::string Header(); //Mean, p50, p90, p99, max (ms) and queries per second, cold and warm
+	std::string Line() const;
+};
+
+LatencyReport MeasureLatency(SimilaritySearch* engine, const std::vector<std::string>& queryIDs, int k, int concurrency, int warmRuns); //concurrency clients take the next query until all are done
+SimilaritySearch* CreateEngine(std::string algorithm, const Database* db, const BenchmarkConfig& config); //nullptr for unknown algorithms
+bool RunBenchmark(const BenchmarkConfig& config);
\ No newline at end of file
@@ -0,0 +1,159 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "Generator.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+CorpusModel::CorpusModel(const Database* db)
+{
+	alphabet = db->alphabet;
+	int alphabetSize = alphabet.size();
+	std::vector<double> firstCounts(alphabetSize, 0);
+	std::vector<double> symbolCounts(alphabetSize, 0);
+	std::vector<std::vector<double>> transitionCounts(alphabetSize, std::vector<double>(alphabetSize, 0));
+	for (int i = 0; i < db->Size(); i++)
+	{
+		std::string_view sequence = db->Sequence(db->Get(i));
+		if (sequence.empty())
+			continue;
+		lengths.push_back(sequence.size());
+		firstCounts[sequence[0]]++;
+		for (int j = 0; j < sequence.size(); j++)
+		{
+			symbolCounts[sequence[j]]++;
+			if (j > 0)
+				transitionCounts[sequence[j - 1]][sequence[j]]++;
+		}
+	}
+	first = std::discrete_distribution<int>(firstCounts.begin(), firstCounts.end());
+	symbols = std::discrete_distribution<int>(symbolCounts.begin(), symbolCounts.end());
+	for (int a = 0; a < alphabetSize; a++)
+	{
+		//Symbols never followed by another: all symbols
+		if (*std::max_element(transitionCounts[a].begin(), transitionCounts[a].end()) == 0)
+			transitionCounts[a] = symbolCounts;
+		transitions.push_back(std::discrete_distribution<int>(transitionCounts[a].begin(), transitionCounts[a].end()));
+	}
+}
+
+std::string CorpusModel::Generate(std::mt19937_64& random)
+{
+	int length = lengths[random() % lengths.size()];
+	std::string sequence(length, 0);
+	sequence[0] = (char)first(random);
+	for (int i = 1; i < length; i++)
+		sequence[i] = (char)transitions[sequence[i - 1]](random);
+	return sequence;
+}
+
+std::string CorpusModel::Mutate(std::string_view sequence, int edits, std::mt19937_64& random)
+{
+	std::string mutated(sequence);
+	for (int e = 0; e < edits; e++)
+	{
+		int operation = random() % 3;
+		if (mutated.size() <= 1)
+			operation = 1; //Insert
+		int pos = random() % (mutated.size() + (operation == 1 ? 1 : 0));
+		if (operation == 0)
+		{
+			//Substitution by a different symbol
+			char symbol = (char)symbols(random);
+			while (symbol == mutated[pos] && alphabet.size() > 1)
+				symbol = (char)(random() % alphabet.size());
+			mutated[pos] = symbol;
+		}
+		else if (operation == 1)
+			mutated.insert(mutated.begin() + pos, (char)symbols(random));
+		else
+			mutated.erase(mutated.begin() + pos);
+	}
+	return mutated;
+}
+
+std::string CorpusModel::Decode(std::string_view sequence) const
+{
+	std::string decoded(sequence.size(), 0);
+	for (int i = 0; i < sequence.size(); i++)
+		decoded[i] = alphabet[sequence[i]];
+	return decoded;
+}
+
+std::string GeneratedID(char prefix, int nr)
+{
+	char id[16];
+	std::snprintf(id, sizeof(id), "%c%08d", prefix, nr);
+	return id;
+}
+
+bool GenerateCorpus(const BenchmarkConfig& config)
+{
+	std::string name = config.databases.empty() ? "emo" : config.databases[0];
+	Database* database = new Database(name.find('.') == std::string::npos ? DatabaseFile(name) : name);
+	if (database->Size() == 0)
+	{
+		std::cout << "Could not load database " << name << "\n";
+		delete database;
+		return false;
+	}
+	long long start = Metrics::Now();
+	CorpusModel model(database);
+	delete database;
+	std::mt19937_64 random(config.seed);
+	int nrOfDuplicates = std::clamp(config.duplicates, 0, config.entries);
+	int nrOfOriginals = config.entries - nrOfDuplicates;
+	if (nrOfOriginals == 0 && nrOfDuplicates > 0)
+	{
+		std::cout << "No entries left to duplicate\n";
+		return false;
+	}
+	//Originals of the duplicates, chosen uniformly (duplicates of duplicates are not planted)
+	std::vector<int> originals(nrOfDuplicates);
+	for (int& original : originals)
+		original = random() % nrOfOriginals;
+	std::sort(originals.begin(), originals.end());
+
+	std::ofstream corpus(config.output + ".txt", std::ios::binary);
+	std::ofstream truth(config.output + " duplicates.txt", std::ios::binary);
+	if (!corpus.is_open() || !truth.is_open())
+	{
+		std::cout << "Could not write " << config.output << ".txt\n";
+		return false;
+	}
+	std::vector<std::string> duplicates(nrOfDuplicates); //Written after the originals
+	int next = 0;
+	std::string line;
+	for (int i = 0; i < nrOfOriginals; i++)
+	{
+		std::string sequence = model.Generate(random);
+		line = GeneratedID('P', i) + " " + model.Decode(sequence) + "\n";
+		corpus.write(line.data(), line.size());
+		for (; next < nrOfDuplicates && originals[next] == i; next++)
+			duplicates[next] = model.Mutate(sequence, config.distance, random);
+	}
+	for (int d = 0; d < nrOfDuplicates; d++)
+	{
+		line = GeneratedID('D', d) + " " + model.Decode(duplicates[d]) + "\n";
+		corpus.write(line.data(), line.size());
+		line = GeneratedID('D', d) + "\t" + GeneratedID('P', originals[d]) + "\tdupl\n";
+		truth.write(line.data(), line.size());
+	}
+	corpus.close();
+	truth.close();
+	double duration = (Metrics::Now() - start) / 1000000.0;
+	std::cout << "Generated " << config.output << ".txt, entries= " << config.entries << ", duplicates= " << nrOfDuplicates << ", time= " << duration << "ms\n";
+	if (config.binary)
+	{
+		Database generated(config.output + ".txt");
+		if (generated.Size() == 0 || !generated.Save(config.output + ".db"))
+		{
+			std::cout << "Could not save " << config.output << ".db\n";
+			return false;
+		}
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include "Benchmark.h"
+#include <random>
+
+//Corpus model learned from a database: entry lengths, first symbols and first order Markov transitions between symbols
+class CorpusModel
+{
+private:
+	//Variables
+	std::string alphabet;
+	std::vector<int> lengths; //Entry lengths of the database, sampled uniformly
+	std::discrete_distribution<int> first; //First symbol of an entry
+	std::vector<std::discrete_distribution<int>> transitions; //transitions[a]: symbol after a
+	std::discrete_distribution<int> symbols; //All symbols, for inserted and substituted symbols
+public:
+	//Methods
+	CorpusModel(const Database* db);
+	std::string Generate(std::mt19937_64& random); //Encoded as in the database
+	std::string Mutate(std::string_view sequence, int edits, std::mt19937_64& random); //Random substitutions, insertions and deletions -> edit distance at most edits
+	std::string Decode(std::string_view sequence) const;
+};
+
+//Writes output.txt (lines "ID sequence") with config.entries entries learned from the first database, config.duplicates of them near-duplicates (IDs D...) of generated entries (IDs P...)
+//Ground truth in "output duplicates.txt" (lines "duplicate<TAB>original<TAB>dupl"), as the query lists
+bool GenerateCorpus(const BenchmarkConfig& config);
\ No newline at end of file
@@ -0,0 +1,239 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "Kernels.h"
+#include "../BLAST/BLAST.h"
+#include "../ED/ED.h"
+#include "../GA/GA.h"
+#include "../LA/LA.h"
+#include "../SSMAW/SSMAW.h"
+#include "../General/Tools.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+
+const int NRPAIRS = 16; //Pairs per measurement, cycled until the minimum time has passed
+const int MUTATIONRATE = 10; //One in MUTATIONRATE symbols of the candidate is substituted
+volatile long long kernelSink = 0; //Keeps the kernel results alive
+
+struct KernelResult
+{
+	std::string kernel;
+	std::string distribution;
+	int length;
+	int threshold; //0 for kernels without a threshold
+	long long cells;
+	double time; //ms
+	double GCUPS() const { return cells / std::max(time * 1000000, 1.0); }
+	std::string Key() const { return kernel + ";" + distribution + ";" + std::to_string(length) + ";" + std::to_string(threshold); }
+};
+
+//Input generation
+std::vector<double> SymbolFrequencies(const Database& db)
+{
+	std::vector<double> frequencies(db.alphabet.size(), 0);
+	for (int i = 0; i < db.Size(); i++)
+		for (char c : db.Sequence(db.Get(i)))
+			frequencies[c]++;
+	return frequencies;
+}
+
+std::vector<std::pair<std::string, std::string>> KernelPairs(const Database& db, const std::vector<double>& frequencies, std::string distribution, int length, std::mt19937& random)
+{
+	std::discrete_distribution<int> skewed(frequencies.begin(), frequencies.end());
+	std::uniform_int_distribution<int> uniform(0, db.alphabet.size() - 1);
+	std::uniform_int_distribution<int> entries(0, db.Size() - 1);
+	std::uniform_int_distribution<int> mutation(0, MUTATIONRATE - 1);
+	std::vector<std::pair<std::string, std::string>> pairs;
+	for (int p = 0; p < NRPAIRS; p++)
+	{
+		std::string query;
+		while (query.size() < (size_t)length)
+		{
+			if (distribution == "real")
+			{
+				//Window of a random entry, followed by the next random entry if it is too short
+				std::string_view entry = db.Sequence(db.Get(entries(random)));
+				int start = entry.size() > length - query.size() ? random() % (entry.size() - (length - query.size()) + 1) : 0;
+				query += entry.substr(start, length - query.size());
+			}
+			else
+				query += (char)(distribution == "uniform" ? uniform(random) : skewed(random));
+		}
+		std::string candidate = query;
+		for (char& c : candidate)
+			if (mutation(random) == 0)
+				c = (char)(distribution == "uniform" ? uniform(random) : skewed(random));
+		pairs.push_back({ query, candidate });
+	}
+	return pairs;
+}
+
+//Measuring
+template <typename F>
+KernelResult MeasureKernel(std::string kernel, std::string distribution, int length, int threshold, int minTime, const std::vector<std::pair<std::string, std::string>>& pairs, F run)
+{
+	//run(query, candidate) returns the number of cells, every pair at least once
+	KernelResult result = { kernel, distribution, length, threshold, 0, 0 };
+	long long start = Metrics::Now();
+	long long end = start + minTime * 1000000LL;
+	int calls = 0;
+	do
+	{
+		const std::pair<std::string, std::string>& pair = pairs[calls % pairs.size()];
+		result.cells += run(std::string_view(pair.first), std::string_view(pair.second));
+		calls++;
+	} while (calls < (int)pairs.size() || Metrics::Now() < end);
+	result.time = (Metrics::Now() - start) / 1000000.0;
+	return result;
+}
+
+//Baseline
+std::map<std::string, double> ReadBaseline(std::string name)
+{
+	std::map<std::string, double> baseline;
+	std::ifstream file(name);
+	std::string line;
+	std::getline(file, line); //Header
+	while (std::getline(file, line))
+	{
+		//Kernel;Distribution;Length;Threshold;GCUPS;
+		size_t pos = 0;
+		for (int i = 0; i < 4 && pos != std::string::npos; i++)
+			pos = line.find(';', pos + 1);
+		if (pos != std::string::npos)
+			baseline[line.substr(0, pos)] = std::stod(line.substr(pos + 1));
+	}
+	return baseline;
+}
+
+void WriteBaseline(std::string name, const std::vector<KernelResult>& results)
+{
+	std::ofstream file(name);
+	file << "Kernel;Distribution;Length;Threshold;GCUPS;\n";
+	for (const KernelResult& result : results)
+		file << result.Key() << ";" << result.GCUPS() << ";\n";
+}
+
+bool KernelBenchmark::Run(const BenchmarkConfig& config)
+{
+	std::string name = config.databases.empty() ? "emo" : config.databases[0];
+	Database db(name.find('.') == std::string::npos ? DatabaseFile(name) : name);
+	if (db.Size() == 0)
+	{
+		std::cout << "Could not load database " << name << "\n";
+		return false;
+	}
+	ED ed(&db);
+	GA ga(&db);
+	LA la(&db);
+	BLAST blast(&db, config.BLT, config.BLA, config.BLX, config.BLq);
+	std::mt19937 random(2021); //Same inputs in every run
+	std::vector<double> frequencies = SymbolFrequencies(db);
+	std::vector<KernelResult> results;
+	for (std::string distribution : config.distributions)
+	{
+		if (distribution != "real" && distribution != "uniform" && distribution != "skewed")
+		{
+			std::cout << "Unknown distribution " << distribution << "\n";
+			continue;
+		}
+		for (int length : config.lengths)
+		{
+			std::cout << "Kernels on " << distribution << " sequences, length= " << length << "\n";
+			std::vector<std::pair<std::string, std::string>> pairs = KernelPairs(db, frequencies, distribution, length, random);
+			long long full = (long long)length * length;
+			results.push_back(MeasureKernel("WagnerFischer", distribution, length, 0, config.minTime, pairs, [&](std::string_view q, std::string_view c)
+				{
+					kernelSink += ed.WagnerFischer(q, c);
+					return full;
+				}));
+			results.push_back(MeasureKernel("Gotoh", distribution, length, 0, config.minTime, pairs, [&](std::string_view q, std::string_view c)
+				{
+					kernelSink += ga.Gotoh(q, c);
+					return full;
+				}));
+			results.push_back(MeasureKernel("SmithWaterman", distribution, length, 0, config.minTime, pairs, [&](std::string_view q, std::string_view c)
+				{
+					kernelSink += la.SmithWaterman(q, c);
+					return full;
+				}));
+			for (int threshold : config.thresholds)
+			{
+				//Substring kernels: candidate segment of a PassJoin partition (threshold + 1 segments) against the whole query
+				int segment = std::max(length / (threshold + 1), 1);
+				int startC = (length - segment) / 2;
+				results.push_back(MeasureKernel("LengthAwareED", distribution, length, threshold, config.minTime, pairs, [&](std::string_view q, std::string_view c)
+					{
+						//Banded with early termination: only the evaluated cells
+						long long cells = 0;
+						kernelSink += LengthAwareED(q, c, 0, length, 0, length, threshold, &cells);
+						return std::max(cells, 1LL);
+					}));
+				results.push_back(MeasureKernel("SubstringEditDistance", distribution, length, threshold, config.minTime, pairs, [&](std::string_view q, std::string_view c)
+					{
+						kernelSink += SubstringEditDistance(q, c, 0, length, startC, segment);
+						return (long long)length * segment;
+					}));
+				results.push_back(MeasureKernel("SubstringHammingDistance", distribution, length, threshold, config.minTime, pairs, [&](std::string_view q, std::string_view c)
+					{
+						kernelSink += (long long)SubstringHammingDistance(q, c, 0, length, startC, segment);
+						return std::max((long long)(length - segment) * segment, 1LL);
+					}));
+			}
+			results.push_back(MeasureKernel("UngappedExtension", distribution, length, 0, config.minTime, pairs, [&](std::string_view q, std::string_view c)
+				{
+					//Seed word in the middle, cells = extended positions
+					int seed = std::max((length - blast.q) / 2, 0);
+					int score = blast.T;
+					int ql; int qr; int el; int er;
+					blast.UngappedExtension(seed, seed, q, c, score, ql, qr, el, er);
+					kernelSink += score;
+					return std::max((long long)(qr - ql + 1), 1LL);
+				}));
+			results.push_back(MeasureKernel("CalculateArrays", distribution, length, 0, config.minTime, pairs, [&](std::string_view q, std::string_view c)
+				{
+					//Cells = symbols of the entry
+					std::vector<int> SA;
+					std::vector<int> LCP;
+					std::vector<std::bitset<53>> B1(q.size() * 2);
+					std::vector<std::bitset<53>> B2(q.size() * 2);
+					CalculateArrays(q, SA, LCP, B1, B2);
+					kernelSink += LCP.back();
+					return (long long)q.size();
+				}));
+		}
+	}
+
+	//Comparison with the baseline
+	std::map<std::string, double> baseline = ReadBaseline(config.baseline);
+	std::ofstream file(config.output + ".csv");
+	file << "Kernel;Distribution;Length;Threshold;Cells;Time (ms);GCUPS;Baseline GCUPS;Ratio;Status;\n";
+	bool passed = true;
+	for (const KernelResult& result : results)
+	{
+		std::string status = "NEW";
+		double reference = 0;
+		double ratio = 0;
+		if (baseline.count(result.Key()) != 0)
+		{
+			reference = baseline[result.Key()];
+			ratio = result.GCUPS() / std::max(reference, 1e-12);
+			status = (ratio * 100 < 100 - config.tolerance) ? "SLOWER" : (ratio * 100 > 100 + config.tolerance) ? "FASTER" : "OK";
+		}
+		if (status == "SLOWER")
+		{
+			passed = false;
+			std::cout << "Slower than baseline: " << result.kernel << ", " << result.distribution << ", length= " << result.length << ", threshold= " << result.threshold
+				<< ", GCUPS= " << result.GCUPS() << " (baseline " << reference << ")\n";
+		}
+		file << result.Key() << ";" << result.cells << ";" << result.time << ";" << result.GCUPS() << ";" << reference << ";" << ratio << ";" << status << ";\n";
+	}
+	if (config.saveBaseline)
+		WriteBaseline(config.baseline, results);
+	return passed;
+}
\ No newline at end of file
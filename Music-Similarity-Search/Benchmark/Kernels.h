@@ -0,0 +1,19 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include "Benchmark.h"
+
+//Micro-benchmarks of the alignment and distance kernels:
+// - Every kernel runs on pairs of a sequence and a mutated copy, for every length, threshold and symbol distribution
+// - real: windows of database entries, uniform: all symbols equally likely, skewed: symbols drawn with their database frequencies
+// - Throughput in cells per second: the DP cells a kernel evaluates, the full matrix (|query| x |candidate|) for the full kernels,
+//   the band up to the early termination for LengthAwareED, so GCUPS compare the cost per cell of kernels doing different amounts of work
+// - Results are compared with the stored baseline of the same kernel, distribution, length and threshold
+class KernelBenchmark
+{
+public:
+	//Methods
+	static bool Run(const BenchmarkConfig& config); //False if a kernel is more than config.tolerance percent below its baseline
+};
\ No newline at end of file
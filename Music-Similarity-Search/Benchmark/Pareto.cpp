@@ -0,0 +1,187 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "Pareto.h"
+#include "../General/Metrics.h"
+#include <fstream>
+#include <iostream>
+
+struct ParetoPoint
+{
+	std::string database;
+	std::string algorithm;
+	std::string setting; //Swept values, e.g. "MAWmin=3 MAWmax=8"
+	std::string list;
+	int queries;
+	double indexTime; //ms
+	double recall; //recall@k
+	double MRR;
+	double falsePositives; //Rate, -1 without negative pairs
+	double p50; //ms
+	double p99; //ms
+	bool pareto = false;
+	bool Dominates(const ParetoPoint& other) const
+	{
+		//At least as good on every objective and better on one, MRR only when the objectives are equal
+		if (recall < other.recall || falsePositives > other.falsePositives || p99 > other.p99)
+			return false;
+		if (recall > other.recall || falsePositives < other.falsePositives || p99 < other.p99)
+			return true;
+		return MRR > other.MRR;
+	}
+};
+
+std::vector<std::string> SweptSettings(std::string algorithm)
+{
+	//Settings of the engine, in the order of CreateEngine
+	if (algorithm == "SSMAW")
+		return { "MAWmin", "MAWmax", "MAWbands", "MAWrows", "MAWprobe" };
+	if (algorithm == "BLAST")
+		return { "BLT", "BLA", "BLX", "BLq" };
+	if (algorithm == "PassJoin")
+		return { "EDthreshold", "PASSchain" };
+	if (algorithm == "PIVOTAL")
+		return { "PIVq", "EDthreshold", "PIVchain" };
+	return {};
+}
+
+std::vector<std::vector<std::pair<std::string, int>>> SweepGrid(const BenchmarkConfig& config, std::string algorithm)
+{
+	std::vector<std::vector<std::pair<std::string, int>>> grid = { {} };
+	for (std::string setting : SweptSettings(algorithm))
+	{
+		auto values = config.sweeps.find(setting);
+		if (values == config.sweeps.end() || values->second.empty())
+			continue;
+		std::vector<std::vector<std::pair<std::string, int>>> next;
+		for (const auto& point : grid)
+			for (int value : values->second)
+			{
+				next.push_back(point);
+				next.back().push_back({ setting, value });
+			}
+		grid = next;
+	}
+	return grid;
+}
+
+double FalsePositiveRate(SimilaritySearch* engine, const std::vector<GroundTruth>& negatives, int k)
+{
+	std::vector<std::string> queries;
+	std::vector<int> results;
+	for (const GroundTruth& pair : negatives)
+	{
+		int result = engine->db->Find(pair.result);
+		if (pair.query == pair.result || result < 0 || engine->db->Find(pair.query) < 0)
+			continue;
+		queries.push_back(pair.query);
+		results.push_back(result);
+	}
+	if (queries.empty())
+		return -1;
+	std::vector<std::vector<Result>> found = engine->SearchBatchID(queries, k);
+	int falsePositives = 0;
+	for (int i = 0; i < queries.size(); i++)
+	{
+		int result = results[i];
+		if (std::any_of(found[i].begin(), found[i].end(), [result](const Result& r) { return r.id == result; }))
+			falsePositives++;
+	}
+	return (double)falsePositives / queries.size();
+}
+
+void WritePareto(const BenchmarkConfig& config, std::vector<ParetoPoint>& points)
+{
+	for (ParetoPoint& point : points)
+	{
+		point.pareto = true;
+		for (const ParetoPoint& other : points)
+			if (other.database == point.database && other.list == point.list && other.Dominates(point))
+				point.pareto = false;
+	}
+	std::ofstream file(config.output + ".csv");
+	file << "Database;Algorithm;Setting;Query list;Queries;Index time (ms);Recall@" << config.k << ";MRR;False positive rate;p50 (ms);p99 (ms);Pareto;\n";
+	for (const ParetoPoint& point : points)
+	{
+		file << point.database << ";" << point.algorithm << ";" << point.setting << ";" << point.list << ";" << point.queries << ";" << point.indexTime << ";"
+			<< point.recall << ";" << point.MRR << ";";
+		if (point.falsePositives >= 0)
+			file << point.falsePositives;
+		file << ";" << point.p50 << ";" << point.p99 << ";" << (point.pareto ? "1" : "0") << ";\n";
+		if (point.pareto)
+			std::cout << "Pareto " << point.database << ", " << point.list << ": " << point.algorithm << " " << point.setting << ", recall@" << config.k << "= " << point.recall
+				<< ", MRR= " << point.MRR << ", false positives= " << point.falsePositives << ", p99= " << point.p99 << " ms\n";
+	}
+}
+
+bool RunPareto(const BenchmarkConfig& config)
+{
+	std::vector<GroundTruth> negatives = QueryList(config.negatives);
+	std::vector<ParetoPoint> points;
+	for (std::string name : config.databases)
+	{
+		Database* database = new Database(name.find('.') == std::string::npos ? DatabaseFile(name) : name);
+		if (database->Size() == 0)
+		{
+			std::cout << "Could not load database " << name << "\n";
+			delete database;
+			continue;
+		}
+		for (std::string algorithm : config.algorithms)
+			for (const auto& point : SweepGrid(config, algorithm))
+			{
+				BenchmarkConfig setting = config;
+				std::string description;
+				for (const auto& value : point)
+				{
+					setting.Set(value.first, std::to_string(value.second));
+					description += (description.empty() ? "" : " ") + value.first + "=" + std::to_string(value.second);
+				}
+				if (setting.MAWmin > setting.MAWmax)
+					continue;
+				std::cout << "Sweeping " << algorithm << (description.empty() ? "" : " " + description) << " on " << name << " (" << database->Size() << " entries)\n";
+				long long start = Metrics::Now();
+				SimilaritySearch* engine = CreateEngine(algorithm, database, setting);
+				if (engine == nullptr)
+				{
+					std::cout << "Unknown algorithm " << algorithm << "\n";
+					break;
+				}
+				double indexTime = (Metrics::Now() - start) / 1000000.0;
+				double falsePositives = FalsePositiveRate(engine, negatives, config.k);
+				for (std::string listName : config.queryLists)
+				{
+					std::vector<GroundTruth> list = PairsInDatabase(QueryList(listName), database);
+					if (list.empty())
+					{
+						std::cout << "No pairs of " << listName << " in " << name << ", skipped\n";
+						continue;
+					}
+					std::vector<std::string> queries;
+					for (const GroundTruth& truth : list)
+						queries.push_back(truth.query);
+					LatencyReport latency = MeasureLatency(engine, queries, config.k, config.concurrency, config.warmRuns);
+					const Histogram& histogram = config.warmRuns > 0 ? latency.warm : latency.cold;
+					std::vector<std::vector<Result>> results = engine->SearchBatchID(queries, config.k);
+					int found = 0;
+					double reciprocalRanks = 0;
+					for (int i = 0; i < list.size(); i++)
+					{
+						int truth = database->Find(list[i].result);
+						auto it = std::find_if(results[i].begin(), results[i].end(), [truth](const Result& r) { return r.id == truth; });
+						if (it == results[i].end())
+							continue;
+						found++;
+						reciprocalRanks += 1.0 / (std::distance(results[i].begin(), it) + 1);
+					}
+					points.push_back({ name, algorithm, description, listName, (int)queries.size(), indexTime, (double)found / list.size(), reciprocalRanks / list.size(),
+						falsePositives, histogram.Percentile(50) / 1000000.0, histogram.Percentile(99) / 1000000.0 });
+				}
+				delete engine;
+			}
+		delete database;
+	}
+	WritePareto(config, points);
+	return !points.empty();
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include "Benchmark.h"
+
+//Accuracy against query cost: every algorithm with every combination of its swept settings (config.sweeps) on every database
+// - Per query list: recall@k and MRR of the ground truth results (reciprocal rank, 0 outside the top k), p50 and p99 latency of the warm runs
+// - False positive rate: fraction of the pairs in config.negatives whose result is in the top k of the query. Pairs of an entry with itself are skipped
+// - Pareto frontier per database and query list: settings no other setting matches or beats on recall@k, false positive rate and p99 latency together (MRR breaks ties)
+std::vector<std::vector<std::pair<std::string, int>>> SweepGrid(const BenchmarkConfig& config, std::string algorithm); //Every combination of the swept settings of the engine: (setting, value) pairs
+bool RunPareto(const BenchmarkConfig& config);
\ No newline at end of file
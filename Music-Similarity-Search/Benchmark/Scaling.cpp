@@ -0,0 +1,124 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "Scaling.h"
+#include "../General/Scheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <omp.h>
+#include <thread>
+
+const double MINTIME = 1; //ms, shorter phases (e.g. engines without an index) get no efficiency
+
+struct ScalingRun
+{
+	std::string algorithm;
+	int entries;
+	int threads;
+	int queries;
+	double buildTime; //ms
+	double queryTime; //ms, whole batch
+	double Time(bool build) const { return build ? buildTime : queryTime / std::max(queries, 1); } //Search per query: databases contain different numbers of the queries
+};
+
+const ScalingRun* FindRun(const std::vector<ScalingRun>& runs, std::string algorithm, double entries, int threads)
+{
+	//Run with about the given number of entries (10%)
+	for (const ScalingRun& run : runs)
+		if (run.algorithm == algorithm && run.threads == threads && std::abs(run.entries - entries) <= 0.1 * entries)
+			return &run;
+	return nullptr;
+}
+
+std::string Efficiency(double efficiency)
+{
+	return efficiency < 0 ? "" : std::to_string(efficiency * 100);
+}
+
+bool RunScaling(const BenchmarkConfig& config)
+{
+	std::vector<int> threadCounts = config.threads;
+	if (threadCounts.empty())
+		for (int t = 1; t <= std::max((int)std::thread::hardware_concurrency(), 1); t *= 2)
+			threadCounts.push_back(t);
+	threadCounts.push_back(1); //Reference of the efficiencies
+	std::sort(threadCounts.begin(), threadCounts.end());
+	threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+	int original = omp_get_max_threads();
+
+	std::vector<ScalingRun> runs;
+	for (std::string name : config.databases)
+	{
+		Database* database = new Database(name.find('.') == std::string::npos ? DatabaseFile(name) : name);
+		if (database->Size() == 0)
+		{
+			std::cout << "Could not load database " << name << "\n";
+			delete database;
+			continue;
+		}
+		//Queries of all lists that are in this database
+		std::vector<std::string_view> queries;
+		for (std::string listName : config.queryLists)
+			for (const GroundTruth& truth : QueryList(listName))
+			{
+				int id = database->Find(truth.query);
+				if (id >= 0)
+					queries.push_back(database->Sequence(database->Get(id)));
+			}
+		for (std::string algorithm : config.algorithms)
+			for (int threads : threadCounts)
+			{
+				std::cout << "Scaling " << algorithm << " on " << name << " (" << database->Size() << " entries), threads= " << threads << "\n";
+				Scheduler::SetThreads(threads);
+				long long start = Metrics::Now();
+				SimilaritySearch* engine = CreateEngine(algorithm, database, config);
+				if (engine == nullptr)
+				{
+					std::cout << "Unknown algorithm " << algorithm << "\n";
+					break;
+				}
+				double buildTime = (Metrics::Now() - start) / 1000000.0;
+				start = Metrics::Now();
+				engine->SearchBatch(queries, config.k);
+				double queryTime = (Metrics::Now() - start) / 1000000.0;
+				runs.push_back({ algorithm, database->Size(), threads, (int)queries.size(), buildTime, queryTime });
+				delete engine;
+			}
+		delete database;
+	}
+	Scheduler::SetThreads(original);
+
+	//Efficiencies
+	std::ofstream file(config.output + ".csv");
+	file << "Algorithm;Entries;Threads;Queries;Build time (ms);Query time (ms);Queries per second;Build strong efficiency (%);Query strong efficiency (%);"
+		<< "Build weak efficiency (%);Query weak efficiency (%);Collapse;\n";
+	for (const ScalingRun& run : runs)
+	{
+		double strong[2] = { -1, -1 };
+		double weak[2] = { -1, -1 };
+		std::string collapse;
+		for (int phase = 0; phase < 2; phase++)
+		{
+			bool build = (phase == 0);
+			const ScalingRun* single = FindRun(runs, run.algorithm, run.entries, 1);
+			if (single != nullptr && (build ? single->buildTime : single->queryTime) >= MINTIME)
+				strong[phase] = single->Time(build) / std::max(run.threads * run.Time(build), 1e-9);
+			const ScalingRun* smaller = FindRun(runs, run.algorithm, (double)run.entries / run.threads, 1);
+			if (smaller != nullptr && (build ? smaller->buildTime : smaller->queryTime) >= MINTIME)
+				weak[phase] = smaller->Time(build) / std::max(run.Time(build), 1e-9);
+			if (run.threads > 1 && ((strong[phase] >= 0 && strong[phase] * 100 < config.collapse) || (weak[phase] >= 0 && weak[phase] * 100 < config.collapse)))
+			{
+				collapse += build ? "build " : "query ";
+				std::cout << "Efficiency collapse: " << run.algorithm << (build ? " index construction" : " search") << ", entries= " << run.entries << ", threads= " << run.threads
+					<< ", strong= " << Efficiency(strong[phase]) << "%, weak= " << Efficiency(weak[phase]) << "%\n";
+			}
+		}
+		file << run.algorithm << ";" << run.entries << ";" << run.threads << ";" << run.queries << ";" << run.buildTime << ";" << run.queryTime << ";"
+			<< run.queries / std::max(run.queryTime / 1000, 1e-9) << ";" << Efficiency(strong[0]) << ";" << Efficiency(strong[1]) << ";"
+			<< Efficiency(weak[0]) << ";" << Efficiency(weak[1]) << ";" << collapse << ";\n";
+	}
+	return !runs.empty();
+}
\ No newline at end of file
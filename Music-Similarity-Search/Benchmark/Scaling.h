@@ -0,0 +1,12 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include "Benchmark.h"
+
+//Thread scaling x corpus scaling: every algorithm on every database with every thread count, index construction and batch search timed separately
+// - Strong scaling efficiency: T(1 thread, n entries) / (t * T(t threads, n entries))
+// - Weak scaling efficiency: T(1 thread, n / t entries) / T(t threads, n entries), for databases with about n / t entries (10%)
+//Efficiencies below config.collapse percent are flagged
+bool RunScaling(const BenchmarkConfig& config);
\ No newline at end of file
@@ -0,0 +1,471 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "SelfTest.h"
+#include "../General/BinaryFile.h"
+#include "../General/QueryBlock.h"
+#include "../General/Scheduler.h"
+#include "../GA/GA.h"
+#include "../LA/LA.h"
+#include "../SSMAW/PostingList.h"
+#include "../SSMAW/SSMAW.h"
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+const char SELFTESTMAGIC[8] = { 'S', 'E', 'L', 'F', 'T', 'E', 'S', 'T' };
+
+bool Check(bool ok, std::string what, int& failures)
+{
+	if (!ok)
+	{
+		std::cout << "FAILED: " << what << "\n";
+		failures++;
+	}
+	return ok;
+}
+
+//PostingList
+std::vector<int> SortedIDs(std::mt19937& random, int count, int width)
+{
+	//Sorted IDs whose gaps (gap - 1 to the previous ID) need at most width bits, one gap of every block needs exactly width bits
+	std::vector<int> entries;
+	long long previous = -1;
+	for (int i = 0; i < count; i++)
+	{
+		uint32_t gap = (width == 0) ? 0 : random() % (1u << (width - 1));
+		if (i % PostingList::BLOCKSIZE == 0 && width > 0)
+			gap = 1u << (width - 1); //Exactly width bits
+		long long room = 0x7FFFFFFFLL - previous - (count - i); //Large widths: the remaining IDs still have to fit in an int
+		if (gap > room)
+			gap = (uint32_t)std::max(room, 0LL);
+		previous += gap + 1;
+		entries.push_back((int)previous);
+	}
+	return entries;
+}
+
+int SelfTest::PostingLists(std::mt19937& random, std::string scratch)
+{
+	int failures = 0;
+	//Block codec: every bit width, including 32 which entry numbers never reach
+	for (int width = 0; width <= 32; width++)
+	{
+		uint32_t in[PostingList::BLOCKSIZE];
+		uint32_t packed[PostingList::BLOCKSIZE];
+		uint32_t out[PostingList::BLOCKSIZE];
+		uint32_t mask = (width == 32) ? 0xFFFFFFFF : (1u << width) - 1;
+		for (int i = 0; i < PostingList::BLOCKSIZE; i++)
+			in[i] = (i == 0) ? mask : (uint32_t)random() & mask;
+		Check(BitWidth(mask) == width, "BitWidth " + std::to_string(width), failures);
+		PackBlock(in, width, packed);
+		UnpackBlock(packed, width, out);
+		Check(std::equal(in, in + PostingList::BLOCKSIZE, out), "PackBlock/UnpackBlock width " + std::to_string(width), failures);
+	}
+	//Lists: bit widths x lengths around the block size (tails of 0, 1 and 127 gaps)
+	for (int width = 0; width <= 31; width++)
+		for (int count : { 0, 1, 127, 128, 129, 255, 256, 300, 1000 })
+		{
+			std::string name = "width " + std::to_string(width) + ", " + std::to_string(count) + " IDs";
+			std::vector<int> entries = SortedIDs(random, count, width);
+			std::vector<int> encoded = entries;
+			PostingList list;
+			list.Encode(encoded);
+			std::vector<int> decoded;
+			list.Decode(decoded);
+			Check(decoded == entries && list.Size() == count, "Encode/Decode " + name, failures);
+			//Count: every other ID and IDs that are not in the list
+			std::vector<int> candidates;
+			std::vector<int> expected;
+			for (int i = 0; i < count; i++)
+			{
+				if (i % 2 == 0)
+				{
+					candidates.push_back(entries[i]);
+					expected.push_back(1);
+				}
+				if (entries[i] > 0 && (i == 0 || entries[i - 1] != entries[i] - 1) && i % 3 == 0)
+				{
+					candidates.push_back(entries[i] - 1);
+					expected.push_back(0);
+				}
+			}
+			std::vector<int> order(candidates.size());
+			for (int i = 0; i < order.size(); i++)
+				order[i] = i;
+			std::sort(order.begin(), order.end(), [&candidates](int a, int b) { return candidates[a] < candidates[b]; });
+			std::vector<int> sorted;
+			std::vector<int> sortedExpected;
+			for (int i : order)
+			{
+				sorted.push_back(candidates[i]);
+				sortedExpected.push_back(expected[i]);
+			}
+			std::vector<int> counts(sorted.size(), 0);
+			list.Count(sorted, counts);
+			Check(counts == sortedExpected, "Count " + name, failures);
+			if (width <= 12) //AddTo needs a dense score array
+			{
+				std::vector<int> score(count == 0 ? 0 : entries.back() + 1, 0);
+				list.AddTo(score);
+				int total = 0;
+				bool ok = true;
+				for (int id : entries)
+					ok = ok && score[id] == 1;
+				for (int s : score)
+					total += s;
+				Check(ok && total == count, "AddTo " + name, failures);
+			}
+		}
+	//Delta segment, merge with removed entries, entries appended during the merge, storage
+	for (int count : { 0, 5, 128, 200, 1000 })
+	{
+		std::string name = std::to_string(count) + " IDs";
+		std::vector<int> entries = SortedIDs(random, count, 6);
+		std::vector<int> encoded = entries;
+		PostingList list;
+		list.Encode(encoded);
+		int next = entries.empty() ? 0 : entries.back() + 1;
+		for (int i = 0; i < 50; i++)
+		{
+			entries.push_back(next);
+			list.Append(next);
+			next += 1 + random() % 5;
+		}
+		std::vector<int> decoded;
+		list.Decode(decoded);
+		Check(decoded == entries && list.Pending() == 50 && list.Size() == entries.size(), "Append " + name, failures);
+		std::vector<bool> removed(next + 100, false);
+		for (int id : entries)
+			if (random() % 4 == 0)
+				removed[id] = true;
+		int consumed;
+		PostingList merged = list.Merge(removed, consumed);
+		for (int i = 0; i < 20; i++) //Appended while merging: stay in the delta segment
+		{
+			entries.push_back(next);
+			list.Append(next);
+			next += 1 + random() % 5;
+		}
+		list.Replace(merged, consumed);
+		std::vector<int> expected;
+		for (int i = 0; i < entries.size(); i++)
+			if (i >= entries.size() - 20 || !removed[entries[i]])
+				expected.push_back(entries[i]);
+		decoded.clear();
+		list.Decode(decoded);
+		Check(consumed == 50 && decoded == expected && list.Pending() == 20, "Merge/Replace " + name, failures);
+		//Storage
+		{
+			BinaryWriter writer(scratch, SELFTESTMAGIC, 1, 0, {});
+			list.Write(writer);
+			Check(writer.Close(), "Write " + name, failures);
+		}
+		BinaryReader reader(scratch, SELFTESTMAGIC, 1, 0, {});
+		PostingList stored;
+		stored.Read(reader);
+		decoded.clear();
+		stored.Decode(decoded);
+		Check(reader.Good() && decoded == expected && stored.Size() == expected.size() && stored.Pending() == 20, "Write/Read " + name, failures);
+	}
+	std::remove(scratch.c_str());
+	return failures;
+}
+
+//QueryBlock
+std::string EncodedSequence(std::mt19937& random, int length, int symbols)
+{
+	//Few symbols give long matching stretches, all 53 mostly mismatches
+	std::string sequence(length, 0);
+	for (char& c : sequence)
+		c = (char)(random() % symbols);
+	return sequence;
+}
+
+int SelfTest::QueryBlocks(std::mt19937& random, std::string scratch)
+{
+	int failures = 0;
+	{
+		std::ofstream file(scratch + ".txt");
+		file << "S0 abc\n";
+	}
+	Database database(scratch + ".txt"); //Only for the alphabet of the substitution matrices
+	std::remove((scratch + ".txt").c_str());
+	GA ga(&database);
+	LA la(&database);
+	const int EDGELENGTHS[] = { 0, 1, 2, 7, QueryBlock::LANES, QueryBlock::LANES + 1, 64, 200 };
+	for (int round = 0; round < 200; round++)
+	{
+		int symbols = (round % 2 == 0) ? 4 : 53;
+		int nrOfQueries = 1 + round % QueryBlock::LANES;
+		int first = random() % 3; //Blocks start anywhere in the query list
+		std::vector<std::string> queries;
+		for (int q = 0; q < first + nrOfQueries; q++)
+		{
+			int length = (random() % 2 == 0) ? EDGELENGTHS[random() % 8] : random() % 150;
+			queries.push_back(EncodedSequence(random, length, symbols));
+		}
+		if (round % 5 == 0)
+			queries[first] = queries.back() + queries.back(); //One query much longer than the others
+		std::vector<std::string_view> views(queries.begin(), queries.end());
+		QueryBlock globalBlock(views, first, first + nrOfQueries, ga.substitutionMatrix);
+		QueryBlock localBlock(views, first, first + nrOfQueries, la.substitutionMatrix);
+		for (int e = 0; e < 4; e++)
+		{
+			int length = (e == 0) ? EDGELENGTHS[round % 8] : random() % 200;
+			std::string entry = EncodedSequence(random, length, symbols);
+			if (e == 1 && !queries[first].empty()) //Entry containing a query
+				entry = EncodedSequence(random, 5, symbols) + queries[first] + EncodedSequence(random, 5, symbols);
+			int global[QueryBlock::LANES];
+			int local[QueryBlock::LANES];
+			globalBlock.Global(entry, global);
+			localBlock.Local(entry, local);
+			for (int q = 0; q < nrOfQueries; q++)
+			{
+				std::string name = "round " + std::to_string(round) + ", query of length " + std::to_string(queries[first + q].size()) + " in lane " + std::to_string(q)
+					+ " of " + std::to_string(nrOfQueries) + ", entry of length " + std::to_string(entry.size());
+				int gotoh = ga.Gotoh(queries[first + q], entry);
+				int smithWaterman = la.SmithWaterman(queries[first + q], entry);
+				Check(global[q] == gotoh, "QueryBlock::Global " + name + ": " + std::to_string(global[q]) + ", Gotoh " + std::to_string(gotoh), failures);
+				Check(local[q] == smithWaterman, "QueryBlock::Local " + name + ": " + std::to_string(local[q]) + ", SmithWaterman " + std::to_string(smithWaterman), failures);
+			}
+		}
+	}
+	return failures;
+}
+
+//Scheduler
+int Job(Scheduler& scheduler, int nrOfTasks, bool nested, int& stolen)
+{
+	//Number of tasks not executed exactly once on a valid worker. Tasks of the first quarter are slow, so the other workers run out and steal
+	std::vector<std::atomic<int>> counts(nrOfTasks);
+	for (std::atomic<int>& count : counts)
+		count = 0;
+	std::atomic<int> invalid{ 0 };
+	std::atomic<int> steals{ 0 };
+	int nrOfWorkers = scheduler.Workers(); //Read once as SimilaritySearch::Scan does, the pool may be resized before Run
+	std::this_thread::yield(); //Room for a concurrent Resize
+	scheduler.Run(nrOfTasks, [&](int task, int worker)
+		{
+			if (worker < 0 || worker >= nrOfWorkers)
+				invalid++;
+			if (worker != (int)((long long)task * nrOfWorkers / nrOfTasks)) //Outside the initial range of the worker
+				steals++;
+			if (task < nrOfTasks / 4)
+				std::this_thread::sleep_for(std::chrono::microseconds(20));
+			if (nested)
+			{
+				//Inner job: executed by this worker alone
+				std::thread::id thread = std::this_thread::get_id();
+				std::vector<int> inner(task % 5, 0);
+				scheduler.Run(inner.size(), [&](int t, int w)
+					{
+						if (std::this_thread::get_id() != thread || w != 0)
+							invalid++;
+						inner[t]++;
+					});
+				if (std::any_of(inner.begin(), inner.end(), [](int c) { return c != 1; }))
+					invalid++;
+			}
+			counts[task]++;
+		}, nrOfWorkers);
+	stolen += steals;
+	for (const std::atomic<int>& count : counts)
+		if (count != 1)
+			invalid++;
+	return invalid;
+}
+
+int SelfTest::Schedulers(std::mt19937& random)
+{
+	int failures = 0;
+	for (int nrOfWorkers = 1; nrOfWorkers <= 4; nrOfWorkers++)
+	{
+		Scheduler scheduler(nrOfWorkers);
+		std::string name = std::to_string(nrOfWorkers) + " workers";
+		int stolen = 0;
+		int invalid = 0;
+		for (int run = 0; run < 100; run++)
+		{
+			int nrOfTasks = (run < 4) ? run : random() % 500; //0 to 3 tasks: fewer tasks than workers
+			invalid += Job(scheduler, nrOfTasks, run % 3 == 0, stolen);
+		}
+		Check(invalid == 0, "Scheduler " + name + ": " + std::to_string(invalid) + " tasks not run exactly once or on an invalid worker", failures);
+		if (nrOfWorkers > 1)
+			Check(stolen > 0, "Scheduler " + name + ": no task was stolen", failures);
+		//Jobs of several threads at once
+		std::atomic<int> concurrent{ 0 };
+		std::vector<std::thread> clients;
+		for (int c = 0; c < 3; c++)
+			clients.push_back(std::thread([&, c]()
+				{
+					int steals = 0;
+					for (int run = 0; run < 30; run++)
+						concurrent += Job(scheduler, (run * 37 + c * 11) % 300, run % 2 == 0, steals);
+				}));
+		for (std::thread& client : clients)
+			client.join();
+		Check(concurrent == 0, "Scheduler " + name + ", concurrent jobs: " + std::to_string(concurrent) + " tasks not run exactly once or on an invalid worker", failures);
+	}
+	//Resized between jobs
+	Scheduler scheduler(2);
+	int invalid = 0;
+	int stolen = 0;
+	for (int run = 0; run < 20; run++)
+	{
+		scheduler.Resize(1 + random() % 4);
+		invalid += Job(scheduler, random() % 200, run % 2 == 0, stolen);
+	}
+	Check(invalid == 0, "Scheduler resized: " + std::to_string(invalid) + " tasks not run exactly once or on an invalid worker", failures);
+	//Resized while another thread submits jobs
+	std::atomic<bool> submitting{ true };
+	std::thread resizer([&]()
+		{
+			for (int sizes = 0; submitting; sizes++)
+			{
+				scheduler.Resize(1 + sizes % 4);
+				std::this_thread::sleep_for(std::chrono::microseconds(50)); //Leaves the pool to the jobs in between
+			}
+		});
+	invalid = 0;
+	for (int run = 0; run < 200; run++)
+		invalid += Job(scheduler, random() % 200, false, stolen);
+	submitting = false;
+	resizer.join();
+	Check(invalid == 0, "Scheduler resized during jobs: " + std::to_string(invalid) + " tasks not run exactly once or on an invalid worker", failures);
+	return failures;
+}
+
+//SSMAW updates
+std::string RandomSequence(std::mt19937& random)
+{
+	std::string sequence(40 + random() % 60, ' ');
+	for (char& c : sequence)
+		c = 'a' + random() % 4; //Few symbols: every entry has MAWs of length 4 to 8
+	return sequence;
+}
+
+int SelfTest::Updates(std::mt19937& random, std::string scratch)
+{
+	int failures = 0;
+	const int BASE = 300;
+	const int ADDED = 200;
+	{
+		std::ofstream file(scratch + ".txt");
+		for (int i = 0; i < BASE; i++)
+			file << "B" << i << " " << RandomSequence(random) << "\n";
+	}
+	Database database(scratch + ".txt");
+	if (!Check(database.Size() == BASE, "SSMAW test database", failures))
+		return failures;
+	SSMAW engine(&database, 4, 8);
+	std::vector<std::string> added;
+	for (int i = 0; i < ADDED; i++)
+		added.push_back(RandomSequence(random));
+	//Removal order: every third database entry and every fifth added entry, interleaved with the additions
+	std::vector<int> removals;
+	std::vector<int> removalOrder(BASE + ADDED, INT_MAX); //Position in removals
+	for (int i = 0; i < ADDED; i++)
+	{
+		if (i < BASE / 3)
+			removals.push_back(3 * i);
+		if (i % 5 == 0)
+			removals.push_back(BASE + i);
+	}
+	for (int i = 0; i < removals.size(); i++)
+		removalOrder[removals[i]] = i;
+
+	//Searches while one thread adds, removes and compacts: an entry removed before the search started is never returned
+	std::atomic<int> removedCount{ 0 };
+	std::atomic<bool> done{ false };
+	std::atomic<int> violations{ 0 };
+	std::vector<std::thread> searchers;
+	for (int t = 0; t < 2; t++)
+		searchers.push_back(std::thread([&, t]()
+			{
+				std::mt19937 local(t);
+				while (!done)
+				{
+					int size = engine.Size();
+					int query = local() % size;
+					int before = removedCount;
+					std::vector<Result> results = engine.SearchSequence(engine.Sequence(query), 10);
+					for (const Result& r : results)
+						if (r.id < 0 || r.id >= engine.Size() || removalOrder[r.id] < before || engine.ID(r.id).empty())
+							violations++;
+				}
+			}));
+	int r = 0;
+	for (int i = 0; i < ADDED; i++)
+	{
+		engine.AddEntry("A" + std::to_string(i), added[i]);
+		while (r < (i + 1) * removals.size() / ADDED && removals[r] <= BASE + i) //Spread over the additions, only entries that exist
+		{
+			engine.RemoveEntry(std::string(engine.ID(removals[r])));
+			removedCount = ++r;
+		}
+		if (i % 50 == 25)
+			engine.CompactAsync();
+	}
+	while (r < removals.size())
+	{
+		engine.RemoveEntry(std::string(engine.ID(removals[r])));
+		removedCount = ++r;
+	}
+	done = true;
+	for (std::thread& searcher : searchers)
+		searcher.join();
+	Check(violations == 0, "SSMAW concurrent searches: " + std::to_string(violations) + " invalid or removed results", failures);
+
+	//Final state, before and after compaction and after storing and loading
+	auto Verify = [&](SSMAW& index, std::string name)
+	{
+		Check(index.Size() == BASE + ADDED, name + ": size", failures);
+		for (int i = 0; i < ADDED; i++)
+		{
+			int entry = BASE + i;
+			Check(index.Find("A" + std::to_string(i)) == entry && index.Sequence(entry) == database.Encode(added[i]), name + ": added entry A" + std::to_string(i), failures);
+		}
+		for (int entry = 0; entry < BASE + ADDED; entry++)
+		{
+			std::vector<Result> results = index.SearchSequence(index.Sequence(entry), 10);
+			bool removed = removalOrder[entry] != INT_MAX;
+			if (!removed)
+				Check(!results.empty() && results[0].id == entry, name + ": entry " + std::to_string(entry) + " is its own best match", failures);
+			for (const Result& result : results)
+				Check(removalOrder[result.id] == INT_MAX, name + ": removed entry " + std::to_string(result.id) + " returned", failures);
+		}
+	};
+	Verify(engine, "SSMAW updates");
+	engine.Compact();
+	Verify(engine, "SSMAW compacted");
+	Check(engine.Save(scratch + ".idx"), "SSMAW save", failures);
+	SSMAW loaded(&database, 4, 8, 0, 0, scratch + ".idx");
+	Verify(loaded, "SSMAW loaded");
+	std::remove((scratch + ".txt").c_str());
+	std::remove((scratch + ".idx").c_str());
+	return failures;
+}
+
+//Running
+bool SelfTest::Run(const BenchmarkConfig& config)
+{
+	std::mt19937 random(config.seed);
+	int failures = 0;
+	std::vector<std::pair<std::string, int>> checks;
+	checks.push_back({ "PostingList", PostingLists(random, config.output + " selftest.bin") });
+	checks.push_back({ "QueryBlock", QueryBlocks(random, config.output + " selftest") });
+	checks.push_back({ "Scheduler", Schedulers(random) });
+	checks.push_back({ "SSMAW updates", Updates(random, config.output + " selftest") });
+	for (const auto& check : checks)
+	{
+		std::cout << check.first << ": " << (check.second == 0 ? "ok" : std::to_string(check.second) + " failures") << "\n";
+		failures += check.second;
+	}
+	return failures == 0;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include "Benchmark.h"
+#include <random>
+
+//Consistency checks of the components that have a simpler reference, mode=selftest:
+// - PostingList: the block codec against the plain sorted IDs, for every bit width, tail length, delta segment, merge and stored list
+// - QueryBlock: Global and Local against the scalar GA::Gotoh and LA::SmithWaterman, random and edge case pairs (empty queries and entries,
+//   queries longer than the others in the block), every block size
+// - Scheduler: every task of a job runs exactly once on a valid worker, with uneven task costs (work stealing), nested Runs,
+//   jobs submitted by several threads at once and pools resized between jobs
+// - SSMAW updates: entries added and removed while other threads search and compactions run, removed entries are never returned once removed
+//   and every added entry is its own best match, also after storing and loading the index
+//Every failing check is printed, Run returns false if any check failed
+class SelfTest
+{
+private:
+	//Methods
+	static int PostingLists(std::mt19937& random, std::string scratch); //Number of failures
+	static int QueryBlocks(std::mt19937& random, std::string scratch);
+	static int Schedulers(std::mt19937& random);
+	static int Updates(std::mt19937& random, std::string scratch);
+public:
+	//Methods
+	static bool Run(const BenchmarkConfig& config);
+};
\ No newline at end of file
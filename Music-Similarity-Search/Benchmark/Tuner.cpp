@@ -0,0 +1,163 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "Tuner.h"
+#include "Pareto.h"
+#include "../General/Metrics.h"
+#include "../PassJoin/PassJoin.h"
+#include "../PIVOTAL/PivotalSearch.h"
+#include <fstream>
+#include <iostream>
+#include <random>
+
+struct TunerRun
+{
+	std::string algorithm;
+	std::vector<std::pair<std::string, int>> setting;
+	double recall = 1; //Lowest recall@k over the query lists
+	double candidates; //Per sampled query
+	double verifications; //Per sampled query
+	double latency; //ms, mean over the sampled queries
+	bool chosen = false;
+	std::string Description() const
+	{
+		std::string description;
+		for (const auto& value : setting)
+			description += (description.empty() ? "" : " ") + value.first + "=" + std::to_string(value.second);
+		return description;
+	}
+};
+
+FilterLog* Filters(SimilaritySearch* engine, std::string algorithm)
+{
+	if (algorithm == "PassJoin")
+		return &static_cast<PassJoin*>(engine)->filterLog;
+	if (algorithm == "PIVOTAL")
+		return &static_cast<PivotalSearch*>(engine)->filterLog;
+	return nullptr;
+}
+
+bool Better(const TunerRun& a, const TunerRun& b, double target)
+{
+	//Reaching the target first, then lower latency; below the target higher recall first
+	bool reachedA = a.recall >= target;
+	bool reachedB = b.recall >= target;
+	if (reachedA != reachedB)
+		return reachedA;
+	if (!reachedA && a.recall != b.recall)
+		return a.recall > b.recall;
+	return a.latency < b.latency;
+}
+
+void WriteSetting(const BenchmarkConfig& config, std::string database, const TunerRun& run)
+{
+	std::ofstream file(config.output + " " + run.algorithm + ".cfg");
+	file << "# " << run.algorithm << " tuned on " << database << ": recall@" << config.k << "= " << run.recall << " (target " << config.targetRecall << "%), "
+		<< run.candidates << " candidates, " << run.verifications << " verifications, " << run.latency << " ms per query\n";
+	for (const auto& value : run.setting)
+		file << value.first << "=" << value.second << "\n";
+}
+
+bool RunTuner(const BenchmarkConfig& config)
+{
+	if (config.databases.empty())
+		return false;
+	std::string name = config.databases[0];
+	Database* database = new Database(name.find('.') == std::string::npos ? DatabaseFile(name) : name);
+	if (database->Size() == 0)
+	{
+		std::cout << "Could not load database " << name << "\n";
+		delete database;
+		return false;
+	}
+
+	//Sampled queries
+	std::mt19937 generator(config.seed);
+	std::uniform_int_distribution<int> entry(0, database->Size() - 1);
+	std::vector<std::string_view> samples;
+	for (int i = 0; i < config.samples; i++)
+		samples.push_back(database->Sequence(database->Get(entry(generator))));
+	//Ground truth pairs in this database
+	std::vector<std::vector<GroundTruth>> lists;
+	for (std::string listName : config.queryLists)
+	{
+		std::vector<GroundTruth> list;
+		for (const GroundTruth& truth : QueryList(listName))
+			if (database->Find(truth.query) >= 0 && database->Find(truth.result) >= 0)
+				list.push_back(truth);
+		if (list.empty())
+			std::cout << "No pairs of " << listName << " in " << name << ", not used for the recall\n";
+		else
+			lists.push_back(list);
+	}
+
+	std::vector<TunerRun> runs;
+	double target = config.targetRecall / 100.0;
+	for (std::string algorithm : config.algorithms)
+	{
+		if (algorithm != "PassJoin" && algorithm != "PIVOTAL")
+		{
+			std::cout << "Not a filter-based engine, not tuned: " << algorithm << "\n";
+			continue;
+		}
+		int best = -1;
+		for (const auto& point : SweepGrid(config, algorithm))
+		{
+			TunerRun run;
+			run.algorithm = algorithm;
+			run.setting = point;
+			BenchmarkConfig setting = config;
+			for (const auto& value : point)
+				setting.Set(value.first, std::to_string(value.second));
+			std::cout << "Tuning " << algorithm << " " << run.Description() << " on " << name << " (" << database->Size() << " entries)\n";
+			SimilaritySearch* engine = CreateEngine(algorithm, database, setting);
+			//Accuracy
+			for (const std::vector<GroundTruth>& list : lists)
+			{
+				std::vector<std::string> queries;
+				for (const GroundTruth& truth : list)
+					queries.push_back(truth.query);
+				std::vector<std::vector<Result>> results = engine->SearchBatchID(queries, config.k);
+				int found = 0;
+				for (int i = 0; i < list.size(); i++)
+				{
+					int truth = database->Find(list[i].result);
+					if (std::any_of(results[i].begin(), results[i].end(), [truth](const Result& r) { return r.id == truth; }))
+						found++;
+				}
+				run.recall = std::min(run.recall, (double)found / list.size());
+			}
+			//Cost, the filters count every sampled query
+			FilterLog* filters = Filters(engine, algorithm);
+			filters->Reset();
+			long long start = Metrics::Now();
+			for (std::string_view query : samples)
+				engine->SearchSequence(query, config.k);
+			run.latency = (Metrics::Now() - start) / 1000000.0 / std::max((int)samples.size(), 1);
+			FilterStats total = filters->Total();
+			run.candidates = (double)total.candidates / std::max(total.queries, 1LL);
+			run.verifications = (double)total.verifications / std::max(total.queries, 1LL);
+			delete engine;
+			runs.push_back(run);
+			if (best < 0 || Better(run, runs[best], target))
+				best = runs.size() - 1;
+		}
+		if (best < 0)
+			continue;
+		runs[best].chosen = true;
+		if (runs[best].recall < target)
+			std::cout << "No " << algorithm << " setting reaches recall@" << config.k << "= " << target << ", highest recall chosen\n";
+		std::cout << "Chosen " << algorithm << " " << runs[best].Description() << ": recall@" << config.k << "= " << runs[best].recall << ", "
+			<< runs[best].latency << " ms per query -> " << config.output << " " << algorithm << ".cfg\n";
+		WriteSetting(config, name, runs[best]);
+	}
+	delete database;
+
+	std::ofstream file(config.output + ".csv");
+	file << "Algorithm;Setting;Recall@" << config.k << ";Candidates per query;Verifications per query;Mean latency (ms);Chosen;\n";
+	for (const TunerRun& run : runs)
+		file << run.algorithm << ";" << run.Description() << ";" << run.recall << ";" << run.candidates << ";" << run.verifications << ";" << run.latency << ";"
+			<< (run.chosen ? "1" : "0") << ";\n";
+	return !runs.empty();
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include "Benchmark.h"
+
+//Settings of the filter-based engines (PassJoin, PIVOTAL) on the first database, candidates are the combinations of the swept settings (config.sweeps):
+// - Cost: config.samples database entries are searched as queries, the filter log of the engine gives the candidates and verifications per query, the mean time the expected latency
+// - Accuracy: recall@k on every query list, pairs with an entry that is not in the database are skipped
+//The setting with the lowest expected latency that reaches config.targetRecall on every list is chosen (the highest recall if none does)
+//and written as a config file "output algorithm.cfg" for the index build, e.g. ./mss "Tuned PassJoin.cfg" algorithms=PassJoin
+bool RunTuner(const BenchmarkConfig& config);
\ No newline at end of file
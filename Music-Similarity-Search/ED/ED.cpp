@@ -4,27 +4,23 @@
 
 #include "ED.h"
 #include "../General/Tools.h";
-#include <iostream>
 #include <string>
 #include <vector>
 #include <algorithm>
-#include <ctime>
 
 //Algorithms and code based on:
 // - Levenshtein, Vladimir I. "Binary codes capable of correcting deletions, insertions, and reversals." Soviet physics doklady. Vol. 10. No. 8. 1966.
 // - Wagner, Robert A., and Michael J. Fischer. "The string-to-string correction problem." Journal of the ACM (JACM) 21.1 (1974): 168-173.
 // - Hirschberg, Daniel S. "A linear space algorithm for computing maximal common subsequences." Communications of the ACM 18.6 (1975): 341-343.
 
-ED::ED(Database* db, int k)
+ED::ED(const Database* db)
 {
 	this->db = db;
-	this->k = k;
 }
 
 //Based on Levenshtein, Wagner-Fischer and Hirschberg algorithms
-int ED::WagnerFischer(std::string query, std::string candidate)
+int ED::WagnerFischer(std::string_view query, std::string_view candidate)
 {
-	std::vector<std::string> result;
 	std::vector<std::vector<int>> matrix;
 	matrix.push_back({});
 	matrix.push_back({});
@@ -57,29 +53,12 @@ int ED::WagnerFischer(std::string query, std::string candidate)
 	return matrix[1][query.size()];
 }
 
-std::vector<Result> ED::SearchSequence(std::string query)
+void ED::ScanShard(const std::vector<std::string_view>& queries, const std::vector<const QueryState*>& states, int begin, int end, std::vector<TopK>& tops)
 {
-#pragma region Searching
-	std::vector<Result> result(db->db.size());
-	std::clock_t start = std::clock();
-#pragma omp parallel for
-	for (int i = 0; i < db->db.size(); i++)
+	for (int i = begin; i < end; i++)
 	{
-		Entry dbentry = db->db[i];
-		std::string entry = dbentry.sequence;
-		double score = WagnerFischer(query, entry);
-		result[i] = Result(dbentry.index, score, true);
+		std::string_view entry = db->Sequence(db->Get(i)); //Loaded once for all queries
+		for (int j = 0; j < queries.size(); j++)
+			tops[j].Push(Result(i, WagnerFischer(queries[j], entry), true));
 	}
-	double duration = (std::clock() - start) / (CLOCKS_PER_SEC / 1000);
-	std::cout << ";;"; //2 x empty
-	std::cout << duration << ";"; //Searching
-#pragma endregion
-
-#pragma region Sorting results
-	start = std::clock();
-	std::sort(result.rbegin(), result.rend());
-	duration = (std::clock() - start) / (CLOCKS_PER_SEC / 1000);
-	std::cout << duration << ";\n"; //Sorting
-#pragma endregion
-	return result;
-}
+}
\ No newline at end of file
@@ -7,11 +7,15 @@
 
 class ED : public SimilaritySearch
 {
+	friend class KernelBenchmark; //Micro-benchmarks of the private kernels
 private:
-	int k;
-	int WagnerFischer(std::string query, std::string candidate);
+	int WagnerFischer(std::string_view query, std::string_view candidate);
+protected:
+	bool Scans() override { return true; }
+	bool LowerIsBetter() override { return true; }
+	void ScanShard(const std::vector<std::string_view>& queries, const std::vector<const QueryState*>& states, int begin, int end, std::vector<TopK>& tops) override;
 public:
 	ED() {}
-	ED(Database* db, int k);
-	std::vector<Result> SearchSequence(std::string query) override;
+	ED(const Database* db);
+	const char* Name() override { return "ED"; }
 };
\ No newline at end of file
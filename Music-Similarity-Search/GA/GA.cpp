@@ -3,22 +3,20 @@
 */
 
 #include "GA.h"
+#include "../General/QueryBlock.h"
 #include "../General/Scoring.h"
-#include <iostream>
 #include <string>
 #include <vector>
 #include <algorithm>
-#include <ctime>
 
 //Algorithms and code based on:
 // - Needleman, Saul B., and Christian D. Wunsch. "A general method applicable to the search for similarities in the amino acid sequence of two proteins." Journal of molecular biology 48.3 (1970): 443-453.
 // - Gotoh, Osamu. "An improved algorithm for matching biological sequences." Journal of molecular biology 162.3 (1982): 705-708.
 // - Hirschberg, Daniel S. "A linear space algorithm for computing maximal common subsequences." Communications of the ACM 18.6 (1975): 341-343.
 
-GA::GA(Database* db, int k)
+GA::GA(const Database* db)
 {
 	this->db = db;
-	this->k = k;
 
 	//Construct substitution matrix
 	for (int i = 0; i < 53; i++)
@@ -27,7 +25,7 @@ GA::GA(Database* db, int k)
 }
 
 //Based on Needleman-Wunsch, Gotoh and Hirschberg algorithms
-int GA::Gotoh(std::string query, std::string candidate)
+int GA::Gotoh(std::string_view query, std::string_view candidate)
 {
 	std::vector<std::vector<int>> Ix;
 	std::vector<std::vector<int>> Iy;
@@ -47,8 +45,8 @@ int GA::Gotoh(std::string query, std::string candidate)
 	for (int i = 1; i <= query.size(); i++)
 	{
 		B[0][i] = value;
-		Ix[0][i] = -INFINITY;
-		Iy[0][i] = -INFINITY;
+		Ix[0][i] = MINSCORE;
+		Iy[0][i] = MINSCORE;
 		value -= e;
 	}
 
@@ -61,13 +59,13 @@ int GA::Gotoh(std::string query, std::string candidate)
 			if (j == 0)
 			{
 				B[1][j] = value;
-				Ix[1][j] = -INFINITY;
-				Iy[1][j] = -INFINITY;
+				Ix[1][j] = MINSCORE;
+				Iy[1][j] = MINSCORE;
 				value -= e;
 			}
 			else
 			{
-				int M = B[0][j - 1] + substitutionMatrix[CharacterIndex(candidate[i])][CharacterIndex(query[j - 1])];
+				int M = B[0][j - 1] + substitutionMatrix[candidate[i]][query[j - 1]];
 				B[1][j] = std::max({ Ix[0][j], Iy[1][j - 1],  M });
 				Ix[1][j] = std::max((M - d), (Ix[0][j] - e));
 				Iy[1][j] = std::max((M - d), (Iy[1][j - 1] - e));
@@ -80,29 +78,24 @@ int GA::Gotoh(std::string query, std::string candidate)
 	return B[1][query.size()];
 }
 
-std::vector<Result> GA::SearchSequence(std::string query)
+void GA::ScanShard(const std::vector<std::string_view>& queries, const std::vector<const QueryState*>& states, int begin, int end, std::vector<TopK>& tops)
 {
-#pragma region Searching
-	std::vector<Result> result(db->db.size());
-	std::clock_t start = std::clock();
-#pragma omp parallel for
-	for (int i = 0; i < db->db.size(); i++)
+	//Queries in blocks of QueryBlock::LANES: every entry is loaded once and aligned against a whole block in one pass
+	std::vector<QueryBlock> blocks;
+	for (int first = 0; first < queries.size(); first += QueryBlock::LANES)
+		blocks.push_back(QueryBlock(queries, first, std::min(first + QueryBlock::LANES, (int)queries.size()), substitutionMatrix));
+	int scores[QueryBlock::LANES];
+	for (int i = begin; i < end; i++)
 	{
-		Entry dbentry = db->db[i];
-		std::string entry = dbentry.sequence;
-		double score = Gotoh(query, entry);
-		result[i] = Result(dbentry.index, score, true);
+		std::string_view entry = db->Sequence(db->Get(i));
+		for (int b = 0; b < blocks.size(); b++)
+		{
+			if (blocks[b].Size() == 1) //A single query doesn't fill the lanes
+				scores[0] = Gotoh(queries[b * QueryBlock::LANES], entry);
+			else
+				blocks[b].Global(entry, scores);
+			for (int j = 0; j < blocks[b].Size(); j++)
+				tops[b * QueryBlock::LANES + j].Push(Result(i, scores[j], true));
+		}
 	}
-	double duration = (std::clock() - start) / (CLOCKS_PER_SEC / 1000);
-	std::cout << ";;"; //2 x empty
-	std::cout << duration << ";"; //Searching
-#pragma endregion
-
-#pragma region Sorting results
-	start = std::clock();
-	std::sort(result.begin(), result.end());
-	duration = (std::clock() - start) / (CLOCKS_PER_SEC / 1000);
-	std::cout << duration << ";\n"; //Sorting
-#pragma endregion
-	return result;
-}
+}
\ No newline at end of file
@@ -7,12 +7,17 @@
 
 class GA : public SimilaritySearch
 {
+	friend class KernelBenchmark; //Micro-benchmarks of the private kernels
+	friend class SelfTest; //QueryBlock::Global against the scalar kernel
 private:
-	int k;
 	int substitutionMatrix[53][53];
-	int Gotoh(std::string query, std::string candidate);
+	int Gotoh(std::string_view query, std::string_view candidate); //Reference for QueryBlock::Global, one query at a time
+protected:
+	bool Scans() override { return true; }
+	bool LowerIsBetter() override { return false; }
+	void ScanShard(const std::vector<std::string_view>& queries, const std::vector<const QueryState*>& states, int begin, int end, std::vector<TopK>& tops) override;
 public:
 	GA() {}
-	GA(Database* db, int k);
-	std::vector<Result> SearchSequence(std::string query) override;
+	GA(const Database* db);
+	const char* Name() override { return "GA"; }
 };
\ No newline at end of file
@@ -0,0 +1,72 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "BinaryFile.h"
+#include <cstdio>
+#include <random>
+
+std::string TemporaryName(std::string name)
+{
+	std::random_device random;
+	return name + "." + std::to_string(random()) + ".tmp";
+}
+
+bool ReplaceFile(std::string temporary, std::string name)
+{
+	//POSIX replaces the target atomically, Windows doesn't rename over an existing file
+	if (std::rename(temporary.c_str(), name.c_str()) == 0)
+		return true;
+	std::remove(name.c_str());
+	if (std::rename(temporary.c_str(), name.c_str()) == 0)
+		return true;
+	std::remove(temporary.c_str());
+	return false;
+}
+
+BinaryWriter::BinaryWriter(std::string name, const char* magic, uint32_t version, uint64_t checksum, const std::vector<int>& parameters)
+{
+	this->name = name;
+	this->temporary = TemporaryName(name);
+	file.open(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+	IndexHeader header = {};
+	std::memcpy(header.magic, magic, sizeof(header.magic));
+	header.version = version;
+	header.nrOfParameters = parameters.size();
+	header.checksum = checksum;
+	Write(header);
+	for (int parameter : parameters)
+		Write<int32_t>(parameter);
+}
+
+bool BinaryWriter::Close()
+{
+	if (closed)
+		return false;
+	closed = true;
+	bool good = file.is_open() && file.flush().good();
+	file.close();
+	if (!good)
+	{
+		std::remove(temporary.c_str());
+		return false;
+	}
+	return ReplaceFile(temporary, name);
+}
+
+BinaryReader::BinaryReader(std::string name, const char* magic, uint32_t version, uint64_t checksum, const std::vector<int>& parameters)
+{
+	if (!file.Open(name))
+		return;
+	good = true;
+	IndexHeader header = Read<IndexHeader>();
+	if (!good || std::memcmp(header.magic, magic, sizeof(header.magic)) != 0 || header.version != version
+		|| header.checksum != checksum || header.nrOfParameters != parameters.size())
+	{
+		good = false;
+		return;
+	}
+	for (int parameter : parameters)
+		if (Read<int32_t>() != parameter)
+			good = false;
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include "MappedFile.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//Versioned binary files for stored indexes. The header holds a magic, the format version, the checksum of the database
+//and the index parameters: a reader is only valid when all of them match, otherwise the index has to be rebuilt
+struct IndexHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t nrOfParameters;
+	uint64_t checksum;
+};
+
+//Files are written to a temporary file next to the target and renamed over it once complete: processes that have the old file mapped
+//keep reading the old contents, and writers that start at the same time don't interleave their writes
+std::string TemporaryName(std::string name); //Unique per call
+bool ReplaceFile(std::string temporary, std::string name); //Renames temporary to name, removes temporary if that fails
+
+class BinaryWriter
+{
+private:
+	//Variables
+	std::ofstream file;
+	std::string name;
+	std::string temporary;
+	bool closed = false;
+public:
+	//Methods
+	BinaryWriter(std::string name, const char* magic, uint32_t version, uint64_t checksum, const std::vector<int>& parameters);
+	~BinaryWriter() { Close(); }
+	bool Good() const { return file.good(); }
+	bool Close(); //Replaces the target file if everything was written, true on success
+	template <typename T>
+	void Write(const T& value)
+	{
+		file.write((const char*)&value, sizeof(T));
+	}
+	template <typename T>
+	void WriteVector(const std::vector<T>& values)
+	{
+		Write<uint64_t>(values.size());
+		if (!values.empty())
+			file.write((const char*)values.data(), values.size() * sizeof(T));
+	}
+	void WriteString(std::string_view s)
+	{
+		Write<uint32_t>(s.size());
+		file.write(s.data(), s.size());
+	}
+};
+
+class BinaryReader
+{
+private:
+	//Variables
+	MappedFile file;
+	size_t pos = 0;
+	bool good = false;
+	//Methods
+	const char* Take(size_t size)
+	{
+		//Bounds checked, a truncated file makes the reader fail instead of reading past the mapping
+		if (!good || file.Size() - pos < size)
+		{
+			good = false;
+			return nullptr;
+		}
+		const char* data = file.Data() + pos;
+		pos += size;
+		return data;
+	}
+public:
+	//Methods
+	BinaryReader(std::string name, const char* magic, uint32_t version, uint64_t checksum, const std::vector<int>& parameters);
+	bool Good() const { return good; }
+	template <typename T>
+	T Read()
+	{
+		T value{};
+		const char* data = Take(sizeof(T));
+		if (data != nullptr)
+			std::memcpy(&value, data, sizeof(T));
+		return value;
+	}
+	template <typename T>
+	void ReadVector(std::vector<T>& values)
+	{
+		uint64_t size = Read<uint64_t>();
+		if (!good || size > (file.Size() - pos) / sizeof(T))
+		{
+			good = false;
+			return;
+		}
+		values.resize(size);
+		const char* data = Take(size * sizeof(T));
+		if (size > 0)
+			std::memcpy(values.data(), data, size * sizeof(T));
+	}
+	std::string_view ReadString()
+	{
+		uint32_t size = Read<uint32_t>();
+		const char* data = Take(size);
+		return (data == nullptr) ? std::string_view() : std::string_view(data, size);
+	}
+};
\ No newline at end of file
@@ -0,0 +1,256 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "Counters.h"
+#include "Metrics.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//Algorithms and code based on:
+// - perf_event_open(2), Linux manual page
+
+struct ThreadCounters
+{
+	std::mutex mutex; //Totals are also read by Counters::Totals
+	std::map<std::pair<const char*, int>, Counters::Total> totals; //Engine names are string literals
+	int fds[Counters::EVENTS];
+	int order[Counters::EVENTS]; //Event of the i-th value of a group read
+	int nrOfEvents = 0;
+	int leader = -1;
+	void Close()
+	{
+#ifdef __linux__
+		for (int i = 0; i < nrOfEvents; i++)
+			close(fds[i]);
+#endif
+		nrOfEvents = 0;
+		leader = -1;
+	}
+};
+
+//Closes the group of a thread when it exits, the totals stay in the registry
+struct ThreadGroup
+{
+	std::shared_ptr<ThreadCounters> counters;
+	~ThreadGroup()
+	{
+		if (counters != nullptr)
+			counters->Close();
+	}
+};
+
+static std::atomic<bool> enabled{ false };
+static bool available[Counters::EVENTS] = {};
+static std::mutex registryMutex;
+static std::vector<std::shared_ptr<ThreadCounters>> registry;
+static thread_local ThreadGroup group;
+
+const char* Counters::Name(Event event)
+{
+	switch (event) {
+	case CYCLES:
+		return "Cycles";
+	case INSTRUCTIONS:
+		return "Instructions";
+	case L1MISSES:
+		return "L1D read misses";
+	case LLCMISSES:
+		return "LLC misses";
+	case BRANCHMISSES:
+		return "Branch misses";
+	case PAGEFAULTS:
+		return "Page faults";
+	default:
+		return "";
+	}
+}
+
+#ifdef __linux__
+void OpenGroup(ThreadCounters& counters)
+{
+	const uint32_t types[Counters::EVENTS] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE };
+	const uint64_t configs[Counters::EVENTS] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+		PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_SW_PAGE_FAULTS };
+	for (int e = 0; e < Counters::EVENTS; e++)
+	{
+		if (!available[e])
+			continue;
+		perf_event_attr attr = {};
+		attr.size = sizeof(attr);
+		attr.type = types[e];
+		attr.config = configs[e];
+		attr.disabled = (counters.leader == -1); //The group starts when the leader is enabled
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		int fd = syscall(SYS_perf_event_open, &attr, 0, -1, counters.leader, 0); //Calling thread, any CPU
+		if (fd < 0)
+			continue;
+		if (counters.leader == -1)
+			counters.leader = fd;
+		counters.fds[counters.nrOfEvents] = fd;
+		counters.order[counters.nrOfEvents] = e;
+		counters.nrOfEvents++;
+	}
+	if (counters.leader != -1)
+	{
+		ioctl(counters.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(counters.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+}
+#endif
+
+ThreadCounters* ThreadGroupCounters()
+{
+	if (group.counters == nullptr)
+	{
+		group.counters = std::make_shared<ThreadCounters>();
+#ifdef __linux__
+		OpenGroup(*group.counters);
+#endif
+		std::lock_guard<std::mutex> lock(registryMutex);
+		registry.push_back(group.counters);
+	}
+	return group.counters.get();
+}
+
+bool Counters::Enable()
+{
+#ifdef __linux__
+	//Events that can be opened on this thread are used by all threads
+	for (int e = 0; e < EVENTS; e++)
+		available[e] = true;
+	ThreadCounters test;
+	OpenGroup(test);
+	for (int e = 0; e < EVENTS; e++)
+		available[e] = false;
+	for (int i = 0; i < test.nrOfEvents; i++)
+		available[test.order[i]] = true;
+	enabled = (test.nrOfEvents > 0);
+	test.Close();
+	return enabled;
+#else
+	return false;
+#endif
+}
+
+void Counters::Disable()
+{
+	enabled = false;
+}
+
+bool Counters::Enabled()
+{
+	return enabled.load(std::memory_order_relaxed);
+}
+
+bool Counters::Available(Event event)
+{
+	return available[event];
+}
+
+bool Counters::Read(Sample& sample)
+{
+	if (!Enabled())
+		return false;
+#ifdef __linux__
+	ThreadCounters* counters = ThreadGroupCounters();
+	if (counters->leader == -1)
+		return false;
+	//Group read: number of values, time enabled, time running, values in opening order
+	uint64_t buffer[3 + EVENTS];
+	if (read(counters->leader, buffer, sizeof(buffer)) < (ssize_t)(3 * sizeof(uint64_t)))
+		return false;
+	sample.enabled = buffer[1];
+	sample.running = buffer[2];
+	for (int e = 0; e < EVENTS; e++)
+		sample.value[e] = 0;
+	for (int i = 0; i < counters->nrOfEvents && i < buffer[0]; i++)
+		sample.value[counters->order[i]] = buffer[3 + i];
+	return true;
+#else
+	return false;
+#endif
+}
+
+void Counters::Add(const char* engine, int phase, const Sample& start, const Sample& end)
+{
+	ThreadCounters* counters = ThreadGroupCounters();
+	long long enabledTime = end.enabled - start.enabled;
+	long long runningTime = end.running - start.running;
+	std::lock_guard<std::mutex> lock(counters->mutex);
+	Total& total = counters->totals[{ engine, phase }];
+	total.spans++;
+	if (runningTime <= 0)
+		return; //Not scheduled on the counters during the span
+	double scale = (double)enabledTime / runningTime;
+	for (int e = 0; e < EVENTS; e++)
+		total.value[e] += (long long)((end.value[e] - start.value[e]) * scale);
+}
+
+std::vector<Counters::Total> Counters::Totals()
+{
+	std::map<std::pair<std::string, int>, Total> merged;
+	std::lock_guard<std::mutex> registryLock(registryMutex);
+	for (std::shared_ptr<ThreadCounters>& counters : registry)
+	{
+		std::lock_guard<std::mutex> lock(counters->mutex);
+		for (auto& element : counters->totals)
+		{
+			Total& total = merged[{ element.first.first, element.first.second }];
+			total.spans += element.second.spans;
+			for (int e = 0; e < EVENTS; e++)
+				total.value[e] += element.second.value[e];
+		}
+	}
+	std::vector<Total> totals;
+	for (auto& element : merged)
+	{
+		Total total = element.second;
+		total.engine = element.first.first;
+		total.phase = element.first.second;
+		for (int e = 0; e < EVENTS; e++)
+			if (!available[e])
+				total.value[e] = -1;
+		totals.push_back(total);
+	}
+	return totals;
+}
+
+void Counters::Reset()
+{
+	std::lock_guard<std::mutex> registryLock(registryMutex);
+	for (std::shared_ptr<ThreadCounters>& counters : registry)
+	{
+		std::lock_guard<std::mutex> lock(counters->mutex);
+		counters->totals.clear();
+	}
+}
+
+std::string Counters::Header()
+{
+	std::string header = "Engine;Phase;Spans;";
+	for (int e = 0; e < EVENTS; e++)
+		header += std::string(Name((Event)e)) + ";";
+	return header + "Instructions per cycle;";
+}
+
+std::string Counters::Line(const Total& total)
+{
+	std::string line = total.engine + ";" + Metrics::Name((Metrics::Phase)total.phase) + ";" + std::to_string(total.spans) + ";";
+	for (int e = 0; e < EVENTS; e++)
+		line += (total.value[e] < 0 ? "" : std::to_string(total.value[e])) + ";";
+	if (total.value[CYCLES] > 0 && total.value[INSTRUCTIONS] >= 0)
+		line += std::to_string((double)total.value[INSTRUCTIONS] / total.value[CYCLES]);
+	return line + ";";
+}
\ No newline at end of file
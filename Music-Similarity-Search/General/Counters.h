@@ -0,0 +1,43 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include <string>
+#include <vector>
+
+//Hardware performance counters of the instrumented phases (Span), opt-in with Enable:
+// - Every thread opens its own perf_event_open counter group on first use, counting that thread in user space only
+// - A span reads the group of its thread at the start and the end, the difference goes to the totals of its engine and phase
+// - Phases that run tasks on other threads (batch scans) count the calling thread only, use one thread to attribute all work
+// - Multiplexed groups are scaled by time enabled / time running
+//Linux only, events the processor or virtual machine doesn't offer are left out (-1 in the totals)
+class Counters
+{
+public:
+	enum Event { CYCLES, INSTRUCTIONS, L1MISSES, LLCMISSES, BRANCHMISSES, PAGEFAULTS, EVENTS };
+	struct Sample
+	{
+		long long value[EVENTS];
+		long long enabled; //ns
+		long long running; //ns
+	};
+	struct Total
+	{
+		std::string engine;
+		int phase; //Metrics::Phase
+		long long spans = 0;
+		long long value[EVENTS] = {};
+	};
+	static const char* Name(Event event);
+	static bool Enable(); //False if no event can be counted
+	static void Disable();
+	static bool Enabled();
+	static bool Available(Event event);
+	static bool Read(Sample& sample); //Counters of the calling thread, false if disabled or unavailable
+	static void Add(const char* engine, int phase, const Sample& start, const Sample& end);
+	static std::vector<Total> Totals(); //Per engine and phase, summed over all threads
+	static void Reset();
+	static std::string Header(); //Spans, events and instructions per cycle
+	static std::string Line(const Total& total);
+};
\ No newline at end of file
@@ -3,36 +3,294 @@
 */
 
 #include "Database.h"
+#include "BinaryFile.h"
+#include "Scoring.h"
 #include "Tools.h"
 #include <fstream>
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <omp.h>
+
+const char MAGIC[8] = { 'M', 'S', 'S', 'D', 'B', 0, 0, 0 };
+const uint32_t VERSION = 1;
+const std::string ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz-";
+
+size_t Align(size_t size)
+{
+	return (size + 7) & ~(size_t)7;
+}
 
 Database::Database(std::string name)
 {
-	std::fstream file;
-	file.open(name, std::ios::in);
-	if (file.is_open())
+	if (!Map(name))
+		Load(name);
+}
+
+//Text format
+struct Chunk
+{
+	//Parsed part of a text database, offsets relative to the chunk
+	std::vector<char> sequences;
+	std::vector<char> ids;
+	std::vector<Entry> entries;
+	std::vector<long long> idEnds;
+	int maxLength = 0;
+	int minLength = INT_MAX;
+	long long sumLengths = 0;
+};
+
+void ParseChunk(const char* begin, const char* end, Chunk& chunk)
+{
+	//Lines "ID sequence", sequences are encoded while parsing
+	while (begin < end)
 	{
-		std::string line;
-		while (std::getline(file, line))
+		const char* lineEnd = (const char*)std::memchr(begin, '\n', end - begin);
+		if (lineEnd == nullptr)
+			lineEnd = end;
+		const char* next = lineEnd + 1;
+		if (lineEnd > begin && lineEnd[-1] == '\r')
+			lineEnd--;
+		const char* space = (const char*)std::memchr(begin, ' ', lineEnd - begin);
+		if (space != nullptr)
 		{
-			int j = 0;
-			while (line[j] != ' ')
-				j++;
-			std::string id = line.substr(0, j);
-			std::string sub = line.substr(j + 1);
-			index[id] = sub;
-			rIndex.push_back(id);
-			int length = sub.length();
-			if (length > maxLength)
-				maxLength = length;
-			if (length < minLength)
-				minLength = length;
-			sumLengths += length;
-			db.push_back(Entry(id, sub));
+			int length = lineEnd - (space + 1);
+			chunk.entries.push_back(Entry(chunk.sequences.size(), length, chunk.entries.size()));
+			for (const char* c = space + 1; c < lineEnd; c++)
+				chunk.sequences.push_back((char)CharacterIndex(*c));
+			chunk.ids.insert(chunk.ids.end(), begin, space);
+			chunk.idEnds.push_back(chunk.ids.size());
+			if (length > chunk.maxLength)
+				chunk.maxLength = length;
+			if (length < chunk.minLength)
+				chunk.minLength = length;
+			chunk.sumLengths += length;
 		}
-		alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz-";
+		begin = next;
+	}
+}
+
+bool Database::Load(std::string name)
+{
+	//Chunks split on line boundaries are parsed in parallel, then copied into the arena at their prefix sum offsets
+	MappedFile text;
+	if (!text.Open(name))
+		return false;
+	const char* data = text.Data();
+	size_t size = text.Size();
+	int nrOfChunks = std::max(1, std::min(omp_get_max_threads() * 4, (int)(size / 65536) + 1));
+	std::vector<size_t> bounds(nrOfChunks + 1, size);
+	bounds[0] = 0;
+	for (int i = 1; i < nrOfChunks; i++)
+	{
+		size_t pos = std::max(bounds[i - 1], size / nrOfChunks * i);
+		const char* newline = (const char*)std::memchr(data + pos, '\n', size - pos);
+		bounds[i] = (newline == nullptr) ? size : newline - data + 1;
 	}
+	std::vector<Chunk> chunks(nrOfChunks);
+#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < nrOfChunks; i++)
+		ParseChunk(data + bounds[i], data + bounds[i + 1], chunks[i]);
+
+	//Merge
+	size_t total = entries.size();
+	size_t sequenceBytes = sequences.size();
+	size_t idBytes = ids.size();
+	std::vector<size_t> entryStart(nrOfChunks), sequenceStart(nrOfChunks), idStart(nrOfChunks);
+	for (int i = 0; i < nrOfChunks; i++)
+	{
+		entryStart[i] = total;
+		sequenceStart[i] = sequenceBytes;
+		idStart[i] = idBytes;
+		total += chunks[i].entries.size();
+		sequenceBytes += chunks[i].sequences.size();
+		idBytes += chunks[i].ids.size();
+		maxLength = std::max(maxLength, chunks[i].maxLength);
+		minLength = std::min(minLength, chunks[i].minLength);
+		sumLengths += chunks[i].sumLengths;
+	}
+	entries.resize(total);
+	sequences.resize(sequenceBytes);
+	ids.resize(idBytes);
+	idOffsets.resize(total + 1);
+#pragma omp parallel for schedule(dynamic)
+	for (int i = 0; i < nrOfChunks; i++)
+	{
+		Chunk& chunk = chunks[i];
+		if (!chunk.sequences.empty())
+			std::memcpy(&sequences[sequenceStart[i]], chunk.sequences.data(), chunk.sequences.size());
+		if (!chunk.ids.empty())
+			std::memcpy(&ids[idStart[i]], chunk.ids.data(), chunk.ids.size());
+		for (int j = 0; j < chunk.entries.size(); j++)
+		{
+			Entry entry = chunk.entries[j];
+			entries[entryStart[i] + j] = Entry(sequenceStart[i] + entry.offset, entry.length, entryStart[i] + entry.id);
+			idOffsets[entryStart[i] + j + 1] = idStart[i] + chunk.idEnds[j];
+		}
+		std::vector<Entry>().swap(chunk.entries);
+		std::vector<char>().swap(chunk.sequences);
+	}
+	nrOfEntries = total;
+	sequenceData = sequences.data();
+	entryData = entries.data();
+	idData = ids.data();
+	idOffsetData = idOffsets.data();
+	//ID lookups by binary search as in the binary format, instead of a hash map that would hold every ID a second time
+	sorted.resize(total);
+	for (int i = 0; i < total; i++)
+		sorted[i] = i;
+	std::stable_sort(sorted.begin(), sorted.end(), [this](int a, int b) { return ID(a) < ID(b); });
+	sortedIDs = sorted.data();
+	alphabet = ALPHABET;
+	return true;
+}
+
+int Database::Find(std::string_view id) const
+{
+	//Binary search, duplicate IDs are sorted on entry number -> the last one wins
+	int low = 0;
+	int high = nrOfEntries;
+	while (low < high)
+	{
+		int mid = (low + high) / 2;
+		if (ID(sortedIDs[mid]) <= id)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	if (low == 0 || ID(sortedIDs[low - 1]) != id)
+		return -1;
+	return sortedIDs[low - 1];
+}
+
+//Binary format
+bool Database::Map(std::string name)
+{
+	//Only the header is checked, the sections are used in place
+	if (!file.Open(name))
+		return false;
+	DatabaseHeader header;
+	if (file.Size() < sizeof(header))
+	{
+		file.Close();
+		return false;
+	}
+	std::memcpy(&header, file.Data(), sizeof(header));
+	size_t count = header.nrOfEntries;
+	size_t pos = Align(sizeof(header));
+	size_t sequencePos = pos;
+	pos += Align(header.sequenceBytes);
+	size_t entryPos = pos;
+	pos += Align(count * sizeof(Entry));
+	size_t idOffsetPos = pos;
+	pos += Align((count + 1) * sizeof(long long));
+	size_t idPos = pos;
+	pos += Align(header.idBytes);
+	size_t sortedPos = pos;
+	pos += Align(count * sizeof(int));
+	if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || file.Size() < pos)
+	{
+		file.Close();
+		return false;
+	}
+	const char* data = file.Data();
+	sequenceData = data + sequencePos;
+	entryData = (const Entry*)(data + entryPos);
+	idOffsetData = (const long long*)(data + idOffsetPos);
+	idData = data + idPos;
+	sortedIDs = (const int*)(data + sortedPos);
+	mappedChecksum = header.checksum;
+	maxLength = header.maxLength;
+	minLength = header.minLength;
+	sumLengths = header.sumLengths;
+	alphabet = ALPHABET;
+	nrOfEntries = count;
+	mapped = true;
+	return true;
+}
+
+void Database::Memory(MemoryReport& report) const
+{
+	if (mapped)
+	{
+		report.Add("Database mapped file", file.Size());
+		return;
+	}
+	report.Add("Database sequences", HeapBytes(sequences));
+	report.Add("Database entries", HeapBytes(entries));
+	report.Add("Database IDs", HeapBytes(ids) + HeapBytes(idOffsets));
+	report.Add("Database sorted IDs", HeapBytes(sorted));
+}
+
+bool Database::Save(std::string name) const
+{
+	DatabaseHeader header = {};
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.nrOfEntries = nrOfEntries;
+	header.checksum = Checksum();
+	header.sequenceBytes = (nrOfEntries == 0) ? 0 : entryData[nrOfEntries - 1].offset + entryData[nrOfEntries - 1].length;
+	header.idBytes = (nrOfEntries == 0) ? 0 : idOffsetData[nrOfEntries];
+	header.sumLengths = sumLengths;
+	header.maxLength = maxLength;
+	header.minLength = minLength;
+
+	//Written next to the target and renamed over it, processes that have the old file mapped keep reading it
+	std::string temporary = TemporaryName(name);
+	std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+	const char padding[8] = {};
+	auto write = [&file, &padding](const void* data, size_t size)
+	{
+		file.write((const char*)data, size);
+		file.write(padding, Align(size) - size);
+	};
+	write(&header, sizeof(header));
+	write(sequenceData, header.sequenceBytes);
+	write(entryData, nrOfEntries * sizeof(Entry));
+	write(idOffsetData, (nrOfEntries + 1) * sizeof(long long));
+	write(idData, header.idBytes);
+	write(sortedIDs, nrOfEntries * sizeof(int));
+	bool good = file.flush().good();
 	file.close();
+	if (!good)
+	{
+		std::remove(temporary.c_str());
+		return false;
+	}
+	return ReplaceFile(temporary, name);
+}
+
+uint64_t Database::Checksum() const
+{
+	//FNV-1a over the sequences, IDs and the entry boundaries (lengths and ID offsets), identifies the database contents for stored indexes:
+	//databases with the same bytes split into other entries differ
+	if (mapped)
+		return mappedChecksum;
+	uint64_t hash = 14695981039346656037ull;
+	auto add = [&hash](const char* data, size_t size)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= (uint8_t)data[i];
+			hash *= 1099511628211ull;
+		}
+	};
+	add(sequences.data(), sequences.size());
+	add(ids.data(), ids.size());
+	for (int i = 0; i < nrOfEntries; i++)
+		add((const char*)&entryData[i].length, sizeof(entryData[i].length));
+	add((const char*)idOffsetData, (nrOfEntries + 1) * sizeof(long long));
+	return hash;
+}
+
+std::string Database::Encode(std::string_view sequence) const
+{
+	//Text sequence -> symbol indices, as stored in the arena
+	std::string encoded(sequence.length(), 0);
+	for (int i = 0; i < sequence.length(); i++)
+		encoded[i] = (char)CharacterIndex(sequence[i]);
+	return encoded;
 }
\ No newline at end of file
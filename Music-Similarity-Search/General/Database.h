@@ -4,22 +4,78 @@
 
 #pragma once
 #include "Entry.h"
+#include "MappedFile.h"
+#include "Memory.h"
+#include <climits>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
 
+//Binary database file (Database::Save), every section starts 8 byte aligned:
+// - DatabaseHeader
+// - Sequence blob: all sequences back to back, encoded as symbol indices
+// - Entry table: Entry of every entry number
+// - ID offsets: nrOfEntries + 1 offsets into the ID blob
+// - ID blob: all IDs back to back
+// - Sorted IDs: entry numbers sorted on ID, for binary search lookups
+struct DatabaseHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t nrOfEntries;
+	uint64_t checksum;
+	uint64_t sequenceBytes;
+	uint64_t idBytes;
+	int64_t sumLengths;
+	int32_t maxLength;
+	int32_t minLength;
+};
+
+//Entries are addressed by their entry number (load order). A database is immutable once loaded, so one database is shared by all indexes
+//without locks. Indexes that support updates keep their added entries themselves (SSMAW::AddEntry)
 class Database
 {
 public:
 	//Variables
-	std::unordered_map<std::string, std::string> index;
-	std::vector<std::string> rIndex;
-	std::vector<Entry> db;
 	int maxLength = 0;
 	int minLength = INT_MAX;
-	int sumLengths = 0;
+	long long sumLengths = 0;
 	std::string alphabet;
+private:
+	//Owned storage: text databases
+	std::vector<char> sequences; //Arena with all sequences back to back, encoded as symbol indices (CharacterIndex)
+	std::vector<Entry> entries; //Entry number -> entry
+	std::vector<char> ids; //Interned IDs back to back
+	std::vector<long long> idOffsets = { 0 };
+	std::vector<int> sorted; //Entry numbers sorted on ID
+	//Mapped storage
+	MappedFile file;
+	uint64_t mappedChecksum = 0;
+	//Current storage, points into the owned or the mapped storage
+	const char* sequenceData = nullptr;
+	const Entry* entryData = nullptr;
+	const char* idData = nullptr;
+	const long long* idOffsetData = idOffsets.data();
+	const int* sortedIDs = nullptr; //Find: binary search on the IDs, same layout as the sorted IDs section
+	bool mapped = false;
+	int nrOfEntries = 0;
+	//Methods
+	bool Map(std::string name);
+	bool Load(std::string name);
+public:
 	//Methods
 	Database() {};
-	Database(std::string name);
+	Database(std::string name); //Binary database (Save) or text file with lines "ID sequence"
+	Database(const Database&) = delete; //The data pointers point into the own storage, a copy would point into the original
+	Database& operator=(const Database&) = delete;
+	int Find(std::string_view id) const; //Entry number of the ID, -1 if not present
+	bool Save(std::string name) const;
+	uint64_t Checksum() const;
+	void Memory(MemoryReport& report) const; //Arena, entry table, IDs and sorted IDs, or the mapped file
+	std::string Encode(std::string_view sequence) const;
+	int Size() const { return nrOfEntries; }
+	const Entry& Get(int id) const { return entryData[id]; }
+	std::string_view Sequence(const Entry& entry) const { return std::string_view(sequenceData + entry.offset, entry.length); }
+	std::string_view ID(int id) const { return std::string_view(idData + idOffsetData[id], idOffsetData[id + 1] - idOffsetData[id]); }
 };
\ No newline at end of file
@@ -3,21 +3,17 @@
 */
 
 #pragma once
-#include <string>
 
 struct Entry
 {
-	std::string index;
-	std::string sequence;
+	long long offset; //Start of the encoded sequence in the database arena
+	int length;
+	int id; //Entry number (load order)
 	Entry() {};
-	Entry(std::string index, std::string sequence)
+	Entry(long long offset, int length, int id)
 	{
-		this->index = index;
-		this->sequence = sequence;
-	}
-
-	bool operator<(const Entry& rhs) const noexcept
-	{
-		return this->sequence < rhs.sequence;
+		this->offset = offset;
+		this->length = length;
+		this->id = id;
 	}
 };
\ No newline at end of file
@@ -0,0 +1,60 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "FilterStats.h"
+
+void FilterStats::Add(const FilterStats& other)
+{
+	queries += other.queries;
+	symbols += other.symbols;
+	lengthSurvivors += other.lengthSurvivors;
+	probes += other.probes;
+	hits += other.hits;
+	candidates += other.candidates;
+	checked += other.checked;
+	orderRejected += other.orderRejected;
+	positionRejected += other.positionRejected;
+	pigeonRingRejected += other.pigeonRingRejected;
+	verifications += other.verifications;
+	successes += other.successes;
+}
+
+std::string FilterStats::Header()
+{
+	return "Queries;Query symbols;Length survivors;Probes;Hits;Candidates;Already checked;Order rejected;Position rejected;PigeonRing rejected;Verifications;Successes;";
+}
+
+std::string FilterStats::Line() const
+{
+	std::string line;
+	for (long long value : { queries, symbols, lengthSurvivors, probes, hits, candidates, checked, orderRejected, positionRejected, pigeonRingRejected, verifications, successes })
+		line += std::to_string(value) + ";";
+	return line;
+}
+
+void FilterLog::Add(const FilterStats& query)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	total.Add(query);
+	queries.push_back(query);
+}
+
+FilterStats FilterLog::Total()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return total;
+}
+
+std::vector<FilterStats> FilterLog::Queries()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return queries;
+}
+
+void FilterLog::Reset()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	total = FilterStats();
+	queries.clear();
+}
\ No newline at end of file
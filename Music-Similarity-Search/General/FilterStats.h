@@ -0,0 +1,44 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include <mutex>
+#include <string>
+#include <vector>
+
+//Where the candidates of the edit distance threshold searches (PassJoin, PivotalSearch) are filtered out.
+//A query counts in its own FilterStats on the stack, which is added to the FilterLog of the engine once at the end of the query
+struct FilterStats
+{
+	long long queries = 0;
+	long long symbols = 0; //Query length
+	long long lengthSurvivors = 0; //Entries with a length within the threshold of the query length
+	long long probes = 0; //Pigeonhole lookups of query substrings / prefixes
+	long long hits = 0; //Lookups with an inverted list
+	long long candidates = 0; //Entries in the inverted lists of the hits
+	long long checked = 0; //Candidates already verified for this query
+	long long orderRejected = 0; //lastPrefixFrequency ordering (PivotalSearch)
+	long long positionRejected = 0; //Q-gram position filter (PivotalSearch)
+	long long pigeonRingRejected = 0;
+	long long verifications = 0; //LengthAwareED calculations
+	long long successes = 0; //Verifications within the threshold
+	void Add(const FilterStats& other);
+	static std::string Header();
+	std::string Line() const;
+};
+
+class FilterLog
+{
+private:
+	//Variables
+	std::mutex mutex;
+	FilterStats total;
+	std::vector<FilterStats> queries; //In order of completion
+public:
+	//Methods
+	void Add(const FilterStats& query);
+	FilterStats Total();
+	std::vector<FilterStats> Queries();
+	void Reset();
+};
\ No newline at end of file
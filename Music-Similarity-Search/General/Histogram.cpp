@@ -0,0 +1,82 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "Histogram.h"
+#include <algorithm>
+#include <cmath>
+
+//Algorithms and code based on:
+// - Tene, Gil. "HdrHistogram: A High Dynamic Range Histogram." (2012), http://hdrhistogram.org
+
+Histogram::Histogram()
+{
+	//63 bit values: highest shift is 63 - SUBBITS - 1
+	counts.assign((64 - SUBBITS) * SUBBUCKETS + SUBBUCKETS, 0);
+}
+
+int Histogram::Bucket(long long value)
+{
+	//Shift the value into [SUBBUCKETS, 2 * SUBBUCKETS), every shift adds SUBBUCKETS buckets
+	unsigned long long v = value;
+	int shift = 0;
+	while ((v >> shift) >= 2 * SUBBUCKETS)
+		shift++;
+	return shift * SUBBUCKETS + (int)(v >> shift);
+}
+
+long long Histogram::Highest(int bucket)
+{
+	if (bucket < 2 * SUBBUCKETS)
+		return bucket;
+	int shift = bucket / SUBBUCKETS - 1;
+	long long mantissa = bucket % SUBBUCKETS + SUBBUCKETS;
+	return ((mantissa + 1) << shift) - 1;
+}
+
+void Histogram::Record(long long value)
+{
+	value = std::max(value, 0LL);
+	counts[Bucket(value)]++;
+	min = (count == 0) ? value : std::min(min, value);
+	max = std::max(max, value);
+	count++;
+	total += value;
+}
+
+void Histogram::Merge(const Histogram& other)
+{
+	if (other.count == 0)
+		return;
+	for (int i = 0; i < counts.size(); i++)
+		counts[i] += other.counts[i];
+	min = (count == 0) ? other.min : std::min(min, other.min);
+	max = std::max(max, other.max);
+	count += other.count;
+	total += other.total;
+}
+
+void Histogram::Reset()
+{
+	std::fill(counts.begin(), counts.end(), 0);
+	count = 0;
+	total = 0;
+	min = 0;
+	max = 0;
+}
+
+long long Histogram::Percentile(double p) const
+{
+	if (count == 0)
+		return 0;
+	//Rank of the percentile, at least the first value
+	long long rank = std::max((long long)std::ceil(p / 100 * count), 1LL);
+	long long seen = 0;
+	for (int i = 0; i < counts.size(); i++)
+	{
+		seen += counts[i];
+		if (seen >= rank)
+			return std::min(Highest(i), max);
+	}
+	return max;
+}
\ No newline at end of file
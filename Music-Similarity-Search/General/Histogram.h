@@ -0,0 +1,38 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include <vector>
+
+//Latency histogram with a bounded relative error (HDR histogram layout):
+// - Values below 2 * SUBBUCKETS are counted exactly
+// - Larger values go to SUBBUCKETS linear buckets per power of two -> relative error below 1 / SUBBUCKETS
+//Percentiles are reported as the highest value of their bucket, never below the true percentile
+class Histogram
+{
+public:
+	static const int SUBBITS = 6;
+	static const int SUBBUCKETS = 1 << SUBBITS;
+private:
+	//Variables
+	std::vector<long long> counts;
+	long long count = 0;
+	long long total = 0;
+	long long min = 0;
+	long long max = 0;
+	//Methods
+	static int Bucket(long long value);
+	static long long Highest(int bucket); //Largest value of the bucket
+public:
+	//Methods
+	Histogram();
+	void Record(long long value); //Non-negative, e.g. nanoseconds
+	void Merge(const Histogram& other);
+	void Reset();
+	long long Count() const { return count; }
+	long long Min() const { return min; }
+	long long Max() const { return max; }
+	double Mean() const { return count == 0 ? 0 : (double)total / count; }
+	long long Percentile(double p) const; //p in [0, 100]
+};
\ No newline at end of file
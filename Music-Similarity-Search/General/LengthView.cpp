@@ -0,0 +1,26 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "LengthView.h"
+#include "Tools.h"
+#include <algorithm>
+
+LengthView::LengthView(const Database* db, bool sequenceOrder)
+{
+	int nrOfEntries = db->Size();
+	order.resize(nrOfEntries);
+	for (int i = 0; i < nrOfEntries; i++)
+		order[i] = i;
+	if (sequenceOrder)
+		std::sort(order.begin(), order.end(), [db](int i, int j)
+			{
+				const Entry& a = db->Get(i);
+				const Entry& b = db->Get(j);
+				if (a.length != b.length)
+					return a.length < b.length;
+				return db->Sequence(a) < db->Sequence(b);
+			});
+	else
+		std::stable_sort(order.begin(), order.end(), [db](int i, int j) { return CompareLength(db->Get(i), db->Get(j)); });
+}
\ No newline at end of file
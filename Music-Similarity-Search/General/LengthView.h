@@ -0,0 +1,22 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include "Database.h"
+#include <vector>
+
+//Permutation of the entry numbers of a database sorted on length. Indexes that process entries by length
+//use this instead of sorting the shared database
+class LengthView
+{
+private:
+	//Variables
+	std::vector<int> order; //Entry numbers sorted on length
+public:
+	//Methods
+	LengthView() {};
+	LengthView(const Database* db, bool sequenceOrder); //sequenceOrder: entries of the same length sorted on their sequence, otherwise on entry number
+	int Size() const { return order.size(); }
+	int operator[](int i) const { return order[i]; }
+};
\ No newline at end of file
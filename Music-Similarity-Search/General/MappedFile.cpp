@@ -0,0 +1,96 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "MappedFile.h"
+#ifdef _WIN32
+#include "windows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+bool MappedFile::Open(std::string name)
+{
+	Close();
+	HANDLE handle = CreateFileA(name.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER length;
+	if (!GetFileSizeEx(handle, &length) || length.QuadPart == 0)
+	{
+		CloseHandle(handle);
+		return false;
+	}
+	HANDLE map = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (map == NULL)
+	{
+		CloseHandle(handle);
+		return false;
+	}
+	void* view = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+	if (view == NULL)
+	{
+		CloseHandle(map);
+		CloseHandle(handle);
+		return false;
+	}
+	file = handle;
+	mapping = map;
+	data = (const char*)view;
+	size = (size_t)length.QuadPart;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mapping != nullptr)
+		CloseHandle(mapping);
+	if (file != nullptr)
+		CloseHandle(file);
+	data = nullptr;
+	mapping = nullptr;
+	file = nullptr;
+	size = 0;
+}
+#else
+bool MappedFile::Open(std::string name)
+{
+	Close();
+	int handle = open(name.c_str(), O_RDONLY);
+	if (handle < 0)
+		return false;
+	struct stat info;
+	if (fstat(handle, &info) != 0 || info.st_size == 0)
+	{
+		close(handle);
+		return false;
+	}
+	void* view = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, handle, 0);
+	if (view == MAP_FAILED)
+	{
+		close(handle);
+		return false;
+	}
+	file = handle;
+	data = (const char*)view;
+	size = info.st_size;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data != nullptr)
+		munmap((void*)data, size);
+	if (file >= 0)
+		close(file);
+	data = nullptr;
+	file = -1;
+	size = 0;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include <cstddef>
+#include <string>
+
+//Read-only memory mapping of a whole file, pages are shared with other processes mapping the same file
+class MappedFile
+{
+private:
+	//Variables
+	const char* data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	void* file = nullptr;
+	void* mapping = nullptr;
+#else
+	int file = -1;
+#endif
+public:
+	//Methods
+	MappedFile() {};
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile() { Close(); }
+	bool Open(std::string name);
+	void Close();
+	const char* Data() const { return data; }
+	size_t Size() const { return size; }
+	bool IsOpen() const { return data != nullptr; }
+};
\ No newline at end of file
@@ -0,0 +1,76 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "Memory.h"
+#ifdef _WIN32
+#include "windows.h"
+#include "psapi.h"
+#else
+#include <fstream>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+long long MemoryReport::Total() const
+{
+	long long total = 0;
+	for (const auto& structure : structures)
+		total += structure.second;
+	return total;
+}
+
+long long HeapBytes(const std::string& s)
+{
+	//Short strings are stored inside the string object
+	const char* data = s.data();
+	if (data >= (const char*)&s && data < (const char*)(&s + 1))
+		return 0;
+	return s.capacity() + 1;
+}
+
+long long HeapBytes(const std::vector<bool>& v)
+{
+	return v.capacity() / 8;
+}
+
+#ifdef _WIN32
+long long CurrentMemory()
+{
+	PROCESS_MEMORY_COUNTERS_EX pmc;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&pmc, sizeof(pmc)))
+		return 0;
+	return pmc.PrivateUsage;
+}
+
+long long PeakMemory()
+{
+	PROCESS_MEMORY_COUNTERS_EX pmc;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&pmc, sizeof(pmc)))
+		return 0;
+	return pmc.PeakWorkingSetSize;
+}
+#else
+long long CurrentMemory()
+{
+	//statm: total program size, resident set size (pages)
+	std::ifstream statm("/proc/self/statm");
+	long long size = 0;
+	long long resident = 0;
+	if (!(statm >> size >> resident))
+		return 0;
+	return resident * sysconf(_SC_PAGESIZE);
+}
+
+long long PeakMemory()
+{
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return usage.ru_maxrss; //Bytes
+#else
+	return usage.ru_maxrss * 1024LL; //Kilobytes
+#endif
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,79 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include <map>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//Memory of the current process in bytes, 0 if the platform doesn't report it
+long long CurrentMemory(); //Windows: private bytes, Linux: resident set size (/proc/self/statm)
+long long PeakMemory(); //Windows: peak working set, POSIX: peak resident set size (getrusage)
+
+//Bytes per data structure of an engine (SimilaritySearch::Memory)
+struct MemoryReport
+{
+	std::vector<std::pair<std::string, long long>> structures;
+	void Add(std::string structure, long long bytes) { structures.push_back({ structure, bytes }); }
+	long long Total() const;
+};
+
+//Heap bytes owned by a container, computed from its sizes:
+// - Vectors and strings exactly (capacity, strings within the small string buffer own nothing)
+// - Node based containers as their nodes (hash map: next pointer and cached hash, map: three pointers and the color) plus the bucket array
+long long HeapBytes(const std::string& s);
+long long HeapBytes(const std::vector<bool>& v);
+template <typename T>
+long long HeapBytes(const T& value);
+template <typename T>
+long long HeapBytes(const std::vector<T>& v);
+template <typename K, typename V>
+long long HeapBytes(const std::pair<K, V>& p);
+template <typename K, typename V, typename H>
+long long HeapBytes(const std::unordered_map<K, V, H>& m);
+template <typename K, typename V>
+long long HeapBytes(const std::map<K, V>& m);
+
+template <typename T>
+long long HeapBytes(const T& value)
+{
+	return 0; //Values without heap storage
+}
+
+template <typename T>
+long long HeapBytes(const std::vector<T>& v)
+{
+	long long bytes = v.capacity() * sizeof(T);
+	if constexpr (!std::is_trivially_copyable_v<T>)
+		for (const T& element : v)
+			bytes += HeapBytes(element);
+	return bytes;
+}
+
+template <typename K, typename V>
+long long HeapBytes(const std::pair<K, V>& p)
+{
+	return HeapBytes(p.first) + HeapBytes(p.second);
+}
+
+template <typename K, typename V, typename H>
+long long HeapBytes(const std::unordered_map<K, V, H>& m)
+{
+	long long bytes = m.bucket_count() * sizeof(void*);
+	for (const auto& element : m)
+		bytes += sizeof(void*) + sizeof(size_t) + sizeof(element) + HeapBytes(element);
+	return bytes;
+}
+
+template <typename K, typename V>
+long long HeapBytes(const std::map<K, V>& m)
+{
+	long long bytes = 0;
+	for (const auto& element : m)
+		bytes += 4 * sizeof(void*) + sizeof(element) + HeapBytes(element);
+	return bytes;
+}
\ No newline at end of file
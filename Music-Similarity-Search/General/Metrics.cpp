@@ -0,0 +1,270 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "Metrics.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+const char* Metrics::Name(Phase phase)
+{
+	switch (phase) {
+	case BUILDINDEX:
+		return "build index";
+	case SUFFIXARRAY:
+		return "suffix array";
+	case MAWS:
+		return "MAW extraction";
+	case FREQUENCIES:
+		return "frequency counting";
+	case TRIEINSERT:
+		return "trie insert";
+	case POSTINGS:
+		return "postings";
+	case INDEXQUERY:
+		return "index query";
+	case CANDIDATES:
+		return "candidates";
+	case SEARCH:
+		return "search";
+	case SCAN:
+		return "scan";
+	case SORT:
+		return "sort";
+	default:
+		return "";
+	}
+}
+
+long long Metrics::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if METRICS
+struct Record
+{
+	const char* engine;
+	Metrics::Phase phase;
+	long long start;
+	long long end;
+};
+
+//Single producer (the owning thread), single consumer (the drain thread)
+struct Ring
+{
+	static const int CAPACITY = 4096;
+	int thread; //Track in the metrics file and the trace, shared by the threads that reuse the ring one after another
+	bool released = false; //Owner exited, reused once drained. Guarded by ringsMutex
+	Record records[CAPACITY];
+	std::atomic<uint64_t> head{ 0 }; //Next record to write, only written by the owner
+	std::atomic<uint64_t> tail{ 0 }; //Next record to drain, only written by the drain thread
+	std::atomic<long long> count[Metrics::PHASES] = {};
+	std::atomic<long long> total[Metrics::PHASES] = {};
+	std::atomic<long long> dropped{ 0 };
+};
+
+static std::atomic<bool> enabled{ false };
+static std::mutex ringsMutex; //Guards rings and the metrics file
+static std::vector<std::unique_ptr<Ring>> rings;
+static std::ofstream metricsFile;
+static std::ofstream traceFile; //Chrome trace, guarded by ringsMutex as well
+static bool firstEvent;
+static long long origin; //Spans are written relative to Open
+static std::thread drainer;
+static std::mutex drainMutex;
+static std::condition_variable drainSignal;
+static bool draining = false;
+
+//Ring of the current thread, released when the thread exits: short-lived threads (latency clients, resized pools, OpenMP teams)
+//reuse the rings of exited threads instead of adding a ring each
+struct RingOwner
+{
+	Ring* ring = nullptr;
+	~RingOwner()
+	{
+		if (ring == nullptr)
+			return;
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		ring->released = true;
+	}
+};
+
+static thread_local RingOwner owner;
+
+Ring* ThreadRing()
+{
+	if (owner.ring == nullptr)
+	{
+		//A released ring is reused once the drain thread has written all its spans, its counters keep adding up
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		for (std::unique_ptr<Ring>& r : rings)
+		{
+			if (r->released && r->tail.load(std::memory_order_acquire) == r->head.load(std::memory_order_relaxed))
+			{
+				r->released = false;
+				owner.ring = r.get();
+				return owner.ring;
+			}
+		}
+		rings.push_back(std::unique_ptr<Ring>(new Ring()));
+		owner.ring = rings.back().get();
+		owner.ring->thread = rings.size() - 1;
+	}
+	return owner.ring;
+}
+
+void Metrics::Record(const char* engine, Phase phase, long long start, long long end)
+{
+	if (!enabled.load(std::memory_order_relaxed))
+		return;
+	Ring* r = ThreadRing();
+	r->count[phase].fetch_add(1, std::memory_order_relaxed);
+	r->total[phase].fetch_add(end - start, std::memory_order_relaxed);
+	uint64_t head = r->head.load(std::memory_order_relaxed);
+	if (head - r->tail.load(std::memory_order_acquire) == Ring::CAPACITY)
+	{
+		r->dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	::Record& record = r->records[head % Ring::CAPACITY];
+	record.engine = engine;
+	record.phase = phase;
+	record.start = start;
+	record.end = end;
+	r->head.store(head + 1, std::memory_order_release);
+}
+
+void Drain()
+{
+	std::lock_guard<std::mutex> lock(ringsMutex);
+	for (std::unique_ptr<Ring>& r : rings)
+	{
+		uint64_t tail = r->tail.load(std::memory_order_relaxed);
+		uint64_t head = r->head.load(std::memory_order_acquire);
+		for (; tail < head; tail++)
+		{
+			const Record& record = r->records[tail % Ring::CAPACITY];
+			metricsFile << record.engine << ";" << Metrics::Name(record.phase) << ";" << r->thread << ";"
+				<< (record.start - origin) / 1000 << ";" << (record.end - record.start) / 1000 << ";\n";
+			if (traceFile.is_open())
+			{
+				//Complete event, timestamps in microseconds
+				traceFile << (firstEvent ? "\n" : ",\n") << "{\"name\": \"" << Metrics::Name(record.phase) << "\", \"cat\": \"" << record.engine
+					<< "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << r->thread << ", \"ts\": " << (record.start - origin) / 1000.0
+					<< ", \"dur\": " << (record.end - record.start) / 1000.0 << "}";
+				firstEvent = false;
+			}
+		}
+		r->tail.store(tail, std::memory_order_release);
+	}
+}
+
+bool Metrics::Trace(std::string name)
+{
+	if (!enabled)
+		return false;
+	std::lock_guard<std::mutex> lock(ringsMutex);
+	if (traceFile.is_open())
+		traceFile.close();
+	traceFile.open(name);
+	if (!traceFile.is_open())
+		return false;
+	traceFile << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+	firstEvent = true;
+	//Spans recorded before the trace started are not part of it
+	for (std::unique_ptr<Ring>& r : rings)
+		r->tail.store(r->head.load());
+	return true;
+}
+
+bool Metrics::Open(std::string name)
+{
+	Close();
+	metricsFile.open(name);
+	if (!metricsFile.is_open())
+		return false;
+	metricsFile << "Engine;Phase;Thread;Start (us);Duration (us);\n";
+	origin = Now();
+	{
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		for (std::unique_ptr<Ring>& r : rings)
+		{
+			r->tail.store(r->head.load());
+			for (int p = 0; p < PHASES; p++)
+			{
+				r->count[p] = 0;
+				r->total[p] = 0;
+			}
+			r->dropped = 0;
+		}
+	}
+	draining = true;
+	drainer = std::thread([]()
+		{
+			std::unique_lock<std::mutex> lock(drainMutex);
+			while (draining)
+			{
+				drainSignal.wait_for(lock, std::chrono::milliseconds(100));
+				Drain();
+			}
+		});
+	enabled = true;
+	return true;
+}
+
+void Metrics::Close()
+{
+	if (!enabled)
+		return;
+	enabled = false;
+	{
+		std::lock_guard<std::mutex> lock(drainMutex);
+		draining = false;
+	}
+	drainSignal.notify_one();
+	drainer.join();
+	Drain();
+	//Totals of the per thread counters
+	std::lock_guard<std::mutex> lock(ringsMutex);
+	metricsFile << "Phase;Count;Total (ms);Mean (us);\n";
+	long long dropped = 0;
+	for (int p = 0; p < PHASES; p++)
+	{
+		long long count = 0;
+		long long total = 0;
+		for (std::unique_ptr<Ring>& r : rings)
+		{
+			count += r->count[p];
+			total += r->total[p];
+		}
+		if (count > 0)
+			metricsFile << Name((Phase)p) << ";" << count << ";" << total / 1000000 << ";" << total / 1000 / count << ";\n";
+	}
+	for (std::unique_ptr<Ring>& r : rings)
+		dropped += r->dropped;
+	metricsFile << "Dropped spans;" << dropped << ";\n";
+	metricsFile.close();
+	if (traceFile.is_open())
+	{
+		//Track names: thread 0 is the first thread that recorded a span
+		for (std::unique_ptr<Ring>& r : rings)
+		{
+			traceFile << (firstEvent ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " << r->thread
+				<< ", \"args\": {\"name\": \"thread " << r->thread << "\"}}";
+			firstEvent = false;
+		}
+		//Spans dropped by full ring buffers are missing from the trace
+		traceFile << "\n], \"otherData\": {\"dropped spans\": \"" << dropped << "\"}}\n";
+		traceFile.close();
+	}
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,87 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include "Counters.h"
+#include <string>
+
+//Compile with METRICS=0 to remove all instrumentation
+#ifndef METRICS
+#define METRICS 1
+#endif
+
+//Wall-clock instrumentation of the search phases:
+// - Spans are timed with a monotonic clock, so phases inside parallel regions are not inflated by the thread count
+// - Every thread records its spans in its own lock-free ring buffer and keeps per phase counters, recording never blocks
+//   (a thread that exits leaves its buffer to the next new thread, so threads that come and go don't add buffers)
+// - A background thread drains the ring buffers to the metrics file, full buffers drop spans (counted)
+// - Optionally the spans are also written as a Chrome trace (trace-event JSON, chrome://tracing or Perfetto): one track per thread shows stragglers and serialized sections, the dropped count is in its metadata
+//Nothing is recorded unless a metrics file is open
+class Metrics
+{
+public:
+	enum Phase { BUILDINDEX, SUFFIXARRAY, MAWS, FREQUENCIES, TRIEINSERT, POSTINGS, //Index construction, the stages are nested in BUILDINDEX
+		INDEXQUERY, CANDIDATES, SEARCH, SCAN, SORT, PHASES }; //Query: setup, candidate generation, verification (SCAN: one database range on a worker), sort
+	static const char* Name(Phase phase);
+	static long long Now(); //Nanoseconds, monotonic
+#if METRICS
+	static bool Open(std::string name);
+	static void Close(); //Drains the remaining spans and writes the per phase totals
+	static bool Trace(std::string name); //Chrome trace of the spans recorded from now until Close, needs an open metrics file
+	static void Record(const char* engine, Phase phase, long long start, long long end);
+#else
+	static bool Open(std::string name) { return true; }
+	static void Close() {}
+	static bool Trace(std::string name) { return false; }
+	static void Record(const char* engine, Phase phase, long long start, long long end) {}
+#endif
+};
+
+//Timed phase of an engine, recorded when the next phase starts or the span goes out of scope
+//With Counters enabled the hardware counters of the phase are added to the totals of the engine
+class Span
+{
+#if METRICS
+private:
+	//Variables
+	const char* engine;
+	Metrics::Phase phase;
+	long long start;
+	bool counting;
+	Counters::Sample counters;
+public:
+	//Methods
+	Span(const char* engine, Metrics::Phase phase)
+	{
+		this->engine = engine;
+		this->phase = phase;
+		counting = Counters::Read(counters);
+		start = Metrics::Now();
+	}
+	~Span()
+	{
+		Metrics::Record(engine, phase, start, Metrics::Now());
+		Counters::Sample end;
+		if (counting && Counters::Read(end))
+			Counters::Add(engine, phase, counters, end);
+	}
+	void Next(Metrics::Phase next)
+	{
+		long long now = Metrics::Now();
+		Metrics::Record(engine, phase, start, now);
+		Counters::Sample end;
+		if (counting && Counters::Read(end))
+		{
+			Counters::Add(engine, phase, counters, end);
+			counters = end;
+		}
+		phase = next;
+		start = now;
+	}
+#else
+public:
+	Span(const char* engine, Metrics::Phase phase) {}
+	void Next(Metrics::Phase next) {}
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,131 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "QueryBlock.h"
+#include "Scoring.h"
+#include <algorithm>
+
+//Algorithms and code based on:
+// - Rognes, Torbjørn. "Faster Smith-Waterman database searches with inter-sequence SIMD parallelisation." BMC bioinformatics 12.1 (2011): 1-11.
+// - Farrar, Michael. "Striped Smith–Waterman speeds database searches six times over other SIMD implementations." Bioinformatics 23.2 (2007): 156-161.
+
+QueryBlock::QueryBlock(const std::vector<std::string_view>& queries, int first, int last, const int (&substitutionMatrix)[53][53])
+{
+	nrOfQueries = last - first;
+	length = 0;
+	for (int lane = 0; lane < LANES; lane++)
+	{
+		lengths[lane] = (lane < nrOfQueries) ? queries[first + lane].size() : 0;
+		length = std::max(length, lengths[lane]);
+	}
+	//Query profile, column 0 and padding score 0
+	int columns = length + 1;
+	profile = std::vector<Lanes>(53 * columns, Lanes());
+	for (int symbol = 0; symbol < 53; symbol++)
+		for (int lane = 0; lane < nrOfQueries; lane++)
+		{
+			std::string_view query = queries[first + lane];
+			for (int j = 1; j <= query.size(); j++)
+				profile[symbol * columns + j].v[lane] = substitutionMatrix[symbol][query[j - 1]];
+		}
+}
+
+void QueryBlock::Global(std::string_view entry, int* scores) const
+{
+	const int d = 2; //Gap opening cost
+	const int e = 1; //Gap extension cost
+	int columns = length + 1;
+	if (entry.empty())
+	{
+		std::fill(scores, scores + LANES, 0);
+		return;
+	}
+	//One row per matrix: B and Ix of the previous row are overwritten column by column, Iy only depends on the current row
+	Lanes minimum;
+	std::fill(minimum.v, minimum.v + LANES, MINSCORE);
+	std::vector<Lanes> B(columns, Lanes());
+	std::vector<Lanes> Ix(columns, minimum);
+	int value = -d;
+	for (int j = 1; j <= length; j++)
+	{
+		std::fill(B[j].v, B[j].v + LANES, value);
+		value -= e;
+	}
+
+	//Calculate values
+	value = -d;
+	for (int i = 0; i < entry.size(); i++)
+	{
+		const Lanes* scoreRow = &profile[entry[i] * columns];
+		Lanes diagonal = B[0];
+		Lanes Iy = minimum;
+		std::fill(B[0].v, B[0].v + LANES, value);
+		value -= e;
+		for (int j = 1; j <= length; j++)
+		{
+			Lanes b = B[j];
+			Lanes ix = Ix[j];
+			Lanes s = scoreRow[j];
+			for (int lane = 0; lane < LANES; lane++) //Independent lanes -> vectorized by the compiler
+			{
+				int M = diagonal.v[lane] + s.v[lane];
+				int best = std::max(std::max(ix.v[lane], Iy.v[lane]), M);
+				diagonal.v[lane] = b.v[lane];
+				ix.v[lane] = std::max(M - d, ix.v[lane] - e);
+				Iy.v[lane] = std::max(M - d, Iy.v[lane] - e);
+				b.v[lane] = best;
+			}
+			B[j] = b;
+			Ix[j] = ix;
+		}
+	}
+	for (int lane = 0; lane < LANES; lane++)
+		scores[lane] = B[lengths[lane]].v[lane];
+}
+
+void QueryBlock::Local(std::string_view entry, int* scores) const
+{
+	const int d = 2; //Gap opening cost
+	const int e = 1; //Gap extension cost
+	int columns = length + 1;
+	Lanes zero = Lanes();
+	Lanes minimum;
+	std::fill(minimum.v, minimum.v + LANES, MINSCORE);
+	std::vector<Lanes> B(columns, zero);
+	std::vector<Lanes> Ix(columns, minimum);
+	//Padding is not part of the query: the best score of a lane is only taken up to its query length
+	std::vector<Lanes> valid(columns, zero);
+	for (int j = 1; j <= length; j++)
+		for (int lane = 0; lane < LANES; lane++)
+			valid[j].v[lane] = (j <= lengths[lane]) ? -1 : 0;
+
+	//Calculate values, column 0 of B stays 0
+	Lanes max = zero;
+	for (int i = 0; i < entry.size(); i++)
+	{
+		const Lanes* scoreRow = &profile[entry[i] * columns];
+		Lanes diagonal = zero;
+		Lanes Iy = minimum;
+		for (int j = 1; j <= length; j++)
+		{
+			Lanes b = B[j];
+			Lanes ix = Ix[j];
+			Lanes s = scoreRow[j];
+			Lanes mask = valid[j];
+			for (int lane = 0; lane < LANES; lane++) //Independent lanes -> vectorized by the compiler
+			{
+				int M = diagonal.v[lane] + s.v[lane];
+				int best = std::max(std::max(std::max(ix.v[lane], Iy.v[lane]), M), 0);
+				diagonal.v[lane] = b.v[lane];
+				ix.v[lane] = std::max(std::max(M - d, ix.v[lane] - e), 0);
+				Iy.v[lane] = std::max(std::max(M - d, Iy.v[lane] - e), 0);
+				b.v[lane] = best;
+				max.v[lane] = std::max(max.v[lane], best & mask.v[lane]);
+			}
+			B[j] = b;
+			Ix[j] = ix;
+		}
+	}
+	std::copy(max.v, max.v + LANES, scores);
+}
\ No newline at end of file
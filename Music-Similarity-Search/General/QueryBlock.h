@@ -0,0 +1,35 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include <string_view>
+#include <vector>
+
+//Block of up to LANES queries aligned against a database entry in one pass (inter-query vectorization):
+// - Query q sits in lane q, every DP cell is computed for all lanes at once, the lane loops are vectorized by the compiler
+// - Queries shorter than the longest one are padded, their cells past the query end are computed but never used
+// - Query profile: substitution scores of every database symbol against every query position, one row per database symbol
+//Same recurrences as GA::Gotoh (Global) and LA::SmithWaterman (Local), so the scores are identical
+class QueryBlock
+{
+public:
+	static const int LANES = 8;
+	//One DP cell for all lanes, copied into locals by the kernels so the compiler sees no aliasing
+	struct Lanes
+	{
+		int v[LANES];
+	};
+private:
+	//Variables
+	int nrOfQueries;
+	int length; //Longest query in the block
+	int lengths[LANES];
+	std::vector<Lanes> profile; //[symbol][column]
+public:
+	//Methods
+	QueryBlock(const std::vector<std::string_view>& queries, int first, int last, const int (&substitutionMatrix)[53][53]); //Queries first..last-1, at most LANES
+	int Size() const { return nrOfQueries; }
+	void Global(std::string_view entry, int* scores) const;
+	void Local(std::string_view entry, int* scores) const;
+};
\ No newline at end of file
@@ -3,16 +3,15 @@
 */
 
 #pragma once
-#include <string>
 struct Result
 {
-	std::string s;
+	int id; //Entry number, resolved to its ID string with Database::ID
 	double score;
 	bool significant;
 	Result() {}
-	Result(std::string s, double score, bool significant)
+	Result(int id, double score, bool significant)
 	{
-		this->s = s;
+		this->id = id;
 		this->score = score;
 		this->significant = significant;
 	}
@@ -24,8 +23,8 @@ struct Result
 		return this->score > rhs.score;
 	}
 
-	bool operator==(const std::string& rhs) const noexcept
+	bool operator==(int rhs) const noexcept
 	{
-		return this->s == rhs;
+		return this->id == rhs;
 	}
 };
\ No newline at end of file
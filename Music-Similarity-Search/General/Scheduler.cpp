@@ -0,0 +1,173 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "Scheduler.h"
+#include <algorithm>
+#include <omp.h>
+
+//Algorithms and code based on:
+// - Blumofe, Robert D., and Charles E. Leiserson. "Scheduling multithreaded computations by work stealing." Journal of the ACM (JACM) 46.5 (1999): 720-748.
+
+thread_local bool insideWorker = false; //Run from inside a task -> executed by the calling worker only
+
+Scheduler::Scheduler(int nrOfWorkers)
+{
+	Start(nrOfWorkers);
+}
+
+Scheduler::~Scheduler()
+{
+	Stop();
+}
+
+void Scheduler::Start(int nrOfWorkers)
+{
+	this->nrOfWorkers = std::max(1, nrOfWorkers);
+	queues.reset(new Queue[this->nrOfWorkers]);
+	stopping = false;
+	generation = 0;
+	for (int worker = 1; worker < this->nrOfWorkers; worker++)
+		threads.push_back(std::thread(&Scheduler::Loop, this, worker));
+}
+
+void Scheduler::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	started.notify_all();
+	for (std::thread& thread : threads)
+		thread.join();
+	threads.clear();
+}
+
+void Scheduler::Resize(int nrOfWorkers)
+{
+	std::lock_guard<std::mutex> serial(running);
+	if (std::max(1, nrOfWorkers) == this->nrOfWorkers)
+		return;
+	Stop();
+	Start(nrOfWorkers);
+}
+
+Scheduler& Scheduler::Shared()
+{
+	static Scheduler scheduler(omp_get_max_threads());
+	return scheduler;
+}
+
+void Scheduler::SetThreads(int nrOfThreads)
+{
+	omp_set_num_threads(std::max(1, nrOfThreads));
+	Shared().Resize(nrOfThreads);
+}
+
+void Scheduler::Loop(int worker)
+{
+	insideWorker = true;
+	int seen = 0;
+	while (true)
+	{
+		bool taking;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			started.wait(lock, [this, seen]() { return stopping || generation != seen; });
+			if (stopping)
+				return;
+			seen = generation;
+			taking = worker < jobWorkers;
+		}
+		if (taking)
+			Work(worker);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--active == 0)
+				finished.notify_one();
+		}
+	}
+}
+
+void Scheduler::Work(int worker)
+{
+	int task;
+	while (Next(worker, task))
+		(*job)(task, worker);
+}
+
+bool Scheduler::Next(int worker, int& task)
+{
+	//Own range first
+	{
+		Queue& own = queues[worker];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (own.begin < own.end)
+		{
+			task = own.begin++;
+			return true;
+		}
+	}
+	//Steal the back half of the range of another worker
+	for (int i = 1; i < jobWorkers; i++)
+	{
+		Queue& victim = queues[(worker + i) % jobWorkers];
+		int begin;
+		int end;
+		{
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			int remaining = victim.end - victim.begin;
+			if (remaining <= 0)
+				continue;
+			end = victim.end;
+			begin = end - (remaining + 1) / 2;
+			victim.end = begin;
+		}
+		Queue& own = queues[worker];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		own.begin = begin + 1;
+		own.end = end;
+		task = begin;
+		return true;
+	}
+	return false;
+}
+
+void Scheduler::Run(int nrOfTasks, const std::function<void(int, int)>& task, int maxWorkers)
+{
+	//One job at a time on the pool: a job submitted while another one runs is executed by the calling thread instead of waiting for it,
+	//so concurrent callers (e.g. latency clients) don't queue behind each other
+	std::unique_lock<std::mutex> serial(running, std::defer_lock);
+	if (insideWorker || !serial.try_lock() || nrOfWorkers == 1 || maxWorkers <= 1) //insideWorker first: the calling worker may hold running
+	{
+		//Nested Runs of these tasks stay on this thread as well
+		bool inside = insideWorker;
+		insideWorker = true;
+		for (int t = 0; t < nrOfTasks; t++)
+			task(t, 0);
+		insideWorker = inside;
+		return;
+	}
+	//Resize holds running as well, so the pool can't change during the job
+	int workers = std::min((int)nrOfWorkers, maxWorkers);
+	for (int worker = 0; worker < workers; worker++)
+	{
+		std::lock_guard<std::mutex> lock(queues[worker].mutex);
+		queues[worker].begin = (long long)nrOfTasks * worker / workers;
+		queues[worker].end = (long long)nrOfTasks * (worker + 1) / workers;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &task;
+		jobWorkers = workers;
+		active = nrOfWorkers - 1;
+		generation++;
+	}
+	started.notify_all();
+	insideWorker = true;
+	Work(0);
+	insideWorker = false;
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this]() { return active == 0; });
+	job = nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Work-stealing thread pool with persistent threads:
+// - Run(n, task) executes task(t, worker) for t = 0..n-1, the calling thread works as worker 0
+// - Run(n, task, maxWorkers) only uses workers 0..maxWorkers-1, so per worker state sized from Workers() stays valid when the pool is resized meanwhile
+// - Every worker starts with a contiguous range of tasks and takes them from the front
+// - A worker without tasks steals the back half of the range of another worker
+// - One job at a time uses the pool: Run from inside a task, or while another thread's job is running, executes all tasks on the calling thread
+//Tasks should be about equally expensive (see SimilaritySearch::Tiles), stealing evens out the estimation errors
+class Scheduler
+{
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		int begin = 0;
+		int end = 0;
+	};
+	//Variables
+	std::atomic<int> nrOfWorkers;
+	std::vector<std::thread> threads;
+	std::unique_ptr<Queue[]> queues;
+	const std::function<void(int, int)>* job = nullptr;
+	std::mutex mutex; //Guards generation, active and stopping
+	std::condition_variable started;
+	std::condition_variable finished;
+	int generation = 0; //Number of jobs started, workers wait for the next one
+	int active = 0; //Workers still busy with the current job
+	int jobWorkers = 0; //Workers taking part in the current job
+	bool stopping = false;
+	std::mutex running; //Held by the job on the pool
+	//Methods
+	void Start(int nrOfWorkers);
+	void Stop();
+	void Loop(int worker);
+	void Work(int worker);
+	bool Next(int worker, int& task);
+public:
+	//Methods
+	Scheduler(int nrOfWorkers);
+	~Scheduler();
+	static Scheduler& Shared(); //Pool of all search engines, omp_get_max_threads() workers
+	static void SetThreads(int nrOfThreads); //Workers of the shared pool and threads of OpenMP regions (index construction)
+	void Resize(int nrOfWorkers); //Waits for the running job, then replaces the threads
+	int Workers() const { return nrOfWorkers; }
+	void Run(int nrOfTasks, const std::function<void(int, int)>& task, int maxWorkers = INT_MAX); //task(task number, worker number < maxWorkers), returns when all tasks are done
+};
\ No newline at end of file
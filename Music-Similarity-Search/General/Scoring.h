@@ -3,6 +3,10 @@
 */
 
 #pragma once
+#include <climits>
+
+const int MINSCORE = INT_MIN / 2; //Minus infinity for alignment cells, subtracting gap costs can't overflow
+
 int CharacterScore(char a);
 int CharacterIndex(char a);
 int IntervalScore(char a, char b);
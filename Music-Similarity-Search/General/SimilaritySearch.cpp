@@ -3,9 +3,127 @@
 */
 
 #include "SimilaritySearch.h"
+#include "Scheduler.h"
+#include <algorithm>
 
-std::vector<Result> SimilaritySearch::SearchSequenceID(std::string queryID)
+std::vector<Result> SimilaritySearch::SearchSequenceID(std::string queryID, int k)
 {
-	std::string query = db->index[queryID];
-	return SearchSequence(query);
+	int id = db->Find(queryID);
+	if (id < 0)
+		return SearchSequence(std::string_view(), k);
+	return SearchSequence(db->Sequence(db->Get(id)), k);
+}
+
+MemoryReport SimilaritySearch::Memory()
+{
+	MemoryReport report;
+	db->Memory(report);
+	return report;
+}
+
+std::vector<int> SimilaritySearch::Tiles(long long queryCost, int nrOfWorkers)
+{
+	//Boundaries of database ranges with about the same cost (query length x entry length): page lengths vary by more than 10x, so equal numbers of entries are not equal work
+	std::call_once(lengthPrefixOnce, [this]()
+		{
+			lengthPrefix.resize(db->Size() + 1, 0);
+			for (int i = 0; i < db->Size(); i++)
+				lengthPrefix[i + 1] = lengthPrefix[i] + db->Get(i).length + 1;
+		});
+	long long total = queryCost * lengthPrefix.back();
+	long long nrOfTiles = std::min({ (long long)db->Size(), (long long)nrOfWorkers * TILESPERWORKER, total / MINCOST });
+	nrOfTiles = std::max(nrOfTiles, 1LL);
+	long long target = std::max(total / nrOfTiles, 1LL);
+	std::vector<int> bounds = { 0 };
+	for (long long tile = 1; tile < nrOfTiles; tile++)
+	{
+		//A tile ends after the first entry at which the cost reaches tile x target
+		long long needed = (target * tile + queryCost - 1) / queryCost;
+		int end = std::lower_bound(lengthPrefix.begin() + bounds.back() + 1, lengthPrefix.end(), needed) - lengthPrefix.begin();
+		if (end >= db->Size())
+			break;
+		bounds.push_back(end);
+	}
+	bounds.push_back(db->Size());
+	return bounds;
+}
+
+std::vector<TopK> SimilaritySearch::Scan(const std::vector<std::string_view>& queries, const std::vector<std::unique_ptr<QueryState>>& states, int k)
+{
+	//Tiles of (query group, database range) on the shared work-stealing pool, one job per group instead of a fork-join per query
+	Scheduler& scheduler = Scheduler::Shared();
+	int nrOfQueries = queries.size();
+	bool lower = LowerIsBetter();
+	std::vector<TopK> tops(nrOfQueries, TopK(k, lower));
+	for (int first = 0; first < nrOfQueries; first += GROUPSIZE)
+	{
+		int last = std::min(first + GROUPSIZE, nrOfQueries);
+		std::vector<std::string_view> group(queries.begin() + first, queries.begin() + last);
+		std::vector<const QueryState*> groupStates;
+		long long queryCost = 0;
+		for (int i = first; i < last; i++)
+		{
+			groupStates.push_back(states[i].get());
+			queryCost += queries[i].size() + 1;
+		}
+		int nrOfWorkers = scheduler.Workers(); //Read once, Run uses at most this many workers even if the pool is resized meanwhile
+		std::vector<int> bounds = Tiles(queryCost, nrOfWorkers);
+		std::vector<std::vector<TopK>> local(nrOfWorkers, std::vector<TopK>(last - first, TopK(k, lower))); //Per worker selections
+		scheduler.Run(bounds.size() - 1, [&](int tile, int worker)
+			{
+				Span span(Name(), Metrics::SCAN);
+				ScanShard(group, groupStates, bounds[tile], bounds[tile + 1], local[worker]);
+			}, nrOfWorkers);
+		for (int worker = 0; worker < nrOfWorkers; worker++)
+			for (int i = first; i < last; i++)
+				tops[i].Merge(local[worker][i - first]);
+	}
+	return tops;
+}
+
+std::vector<Result> SimilaritySearch::SearchSequence(std::string_view query, int k)
+{
+	//Scanning engines: a batch of one query
+	Span span(Name(), Metrics::INDEXQUERY);
+	std::vector<std::string_view> queries = { query };
+	std::vector<std::unique_ptr<QueryState>> states;
+	states.push_back(Prepare(query));
+	span.Next(Metrics::SEARCH);
+	std::vector<TopK> tops = Scan(queries, states, k);
+	span.Next(Metrics::SORT);
+	return tops[0].Results();
+}
+
+std::vector<std::vector<Result>> SimilaritySearch::SearchBatch(const std::vector<std::string_view>& queries, int k)
+{
+	int nrOfQueries = queries.size();
+	std::vector<std::vector<Result>> results(nrOfQueries);
+	Scheduler& scheduler = Scheduler::Shared();
+	if (!Scans())
+	{
+		//Index based: one task per query
+		scheduler.Run(nrOfQueries, [&](int i, int worker) { results[i] = SearchSequence(queries[i], k); });
+		return results;
+	}
+	//Query setup once per query, then one pass over the database for all queries
+	Span span(Name(), Metrics::INDEXQUERY);
+	std::vector<std::unique_ptr<QueryState>> states(nrOfQueries);
+	scheduler.Run(nrOfQueries, [&](int i, int worker) { states[i] = Prepare(queries[i]); });
+	span.Next(Metrics::SEARCH);
+	std::vector<TopK> tops = Scan(queries, states, k);
+	span.Next(Metrics::SORT);
+	for (int i = 0; i < nrOfQueries; i++)
+		results[i] = tops[i].Results();
+	return results;
+}
+
+std::vector<std::vector<Result>> SimilaritySearch::SearchBatchID(const std::vector<std::string>& queryIDs, int k)
+{
+	std::vector<std::string_view> queries;
+	for (const std::string& queryID : queryIDs)
+	{
+		int id = db->Find(queryID);
+		queries.push_back(id < 0 ? std::string_view() : db->Sequence(db->Get(id)));
+	}
+	return SearchBatch(queries, k);
 }
\ No newline at end of file
@@ -4,16 +4,47 @@
 
 #pragma once
 #include "Database.h"
+#include "Metrics.h"
 #include "Result.h"
+#include "TopK.h"
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
+//Per query setup (e.g. the BLAST word index), computed once per query and shared by all database shards
+struct QueryState
+{
+	virtual ~QueryState() {}
+};
+
 class SimilaritySearch
 {
+protected:
+	//Variables
+	static const int GROUPSIZE = 16; //Queries per tile, every entry of a shard is loaded once for all of them
+	static const int TILESPERWORKER = 8; //Tiles per scheduler worker, leaves work to steal
+	static const long long MINCOST = 1 << 16; //Minimum cost of a tile (DP cells)
+	std::vector<long long> lengthPrefix; //Sum of (length + 1) of the entries before each entry, built by the first Tiles
+	std::once_flag lengthPrefixOnce;
+	//Methods
+	//Scanning engines (every entry is scored) implement Scans, Prepare and ScanShard, index based engines implement SearchSequence
+	virtual bool Scans() { return false; }
+	virtual bool LowerIsBetter() { return true; }
+	virtual std::unique_ptr<QueryState> Prepare(std::string_view query) { return nullptr; }
+	virtual void ScanShard(const std::vector<std::string_view>& queries, const std::vector<const QueryState*>& states, int begin, int end, std::vector<TopK>& tops) {}
+	std::vector<int> Tiles(long long queryCost, int nrOfWorkers);
+	std::vector<TopK> Scan(const std::vector<std::string_view>& queries, const std::vector<std::unique_ptr<QueryState>>& states, int k);
 public:
 	//Methods
-	Database* db;
+	const Database* db; //Shared, indexes never modify it
 	SimilaritySearch() {};
-	virtual std::vector<Result> SearchSequence(std::string query) = 0;
-	std::vector<Result> SearchSequenceID(std::string queryID);
+	virtual ~SimilaritySearch() {};
+	virtual const char* Name() = 0; //Engine name in the metrics
+	virtual MemoryReport Memory(); //Bytes of the database and of every index structure
+	virtual std::vector<Result> SearchSequence(std::string_view query, int k); //k best results, best first. Query encoded as in the database (Database::Encode)
+	std::vector<Result> SearchSequenceID(std::string queryID, int k);
+	std::vector<std::vector<Result>> SearchBatch(const std::vector<std::string_view>& queries, int k); //k best results for every query
+	std::vector<std::vector<Result>> SearchBatchID(const std::vector<std::string>& queryIDs, int k);
 };
\ No newline at end of file
@@ -8,9 +8,10 @@
 #include<vector>
 #include<algorithm>
 #include<bitset>
+#include<cmath>
 
 //Based on: Li, Guoliang, et al. "Pass-join: A partition-based method for similarity joins." arXiv preprint arXiv:1111.7171 (2011).
-int LengthAwareED(std::string query, std::string candidate, int startQ, int lengthQ, int startC, int lengthC, int threshold)
+int LengthAwareED(std::string_view query, std::string_view candidate, int startQ, int lengthQ, int startC, int lengthC, int threshold, long long* cells)
 {
 	//Base cases
 	if (lengthQ == 0 && lengthC == 0)
@@ -22,7 +23,7 @@ int LengthAwareED(std::string query, std::string candidate, int startQ, int leng
 	//String A has to be longer than string B, so if A < B swap
 	if (lengthQ < lengthC)
 	{
-		std::string temp = candidate;
+		std::string_view temp = candidate;
 		candidate = query;
 		query = temp;
 		int tempI = startC;
@@ -32,7 +33,6 @@ int LengthAwareED(std::string query, std::string candidate, int startQ, int leng
 		lengthC = lengthQ;
 		lengthQ = tempI;
 	}
-	std::vector<std::string> result;
 	std::vector<std::vector<int>> matrix;
 	matrix.push_back({});
 	matrix.push_back({});
@@ -52,6 +52,8 @@ int LengthAwareED(std::string query, std::string candidate, int startQ, int leng
 		int upperJ = std::min(lengthQ, (int)(i + floor((threshold + delta) / 2)));
 		int ETcount = 0;
 		int ETmax = upperJ - lowerJ + 1;
+		if (cells != nullptr)
+			*cells += ETmax;
 		//Set first j value
 		if (lowerJ == 0)
 		{
@@ -85,7 +87,7 @@ int LengthAwareED(std::string query, std::string candidate, int startQ, int leng
 	return matrix[1][lengthQ];
 }
 
-int SubstringEditDistance(std::string query, std::string candidate, int startQ, int lengthQ, int startC, int lengthC)
+int SubstringEditDistance(std::string_view query, std::string_view candidate, int startQ, int lengthQ, int startC, int lengthC)
 {
 	//Initialize matrix
 	std::vector<std::vector<int>> matrix;
@@ -117,13 +119,13 @@ int SubstringEditDistance(std::string query, std::string candidate, int startQ,
 	return min;
 }
 
-double SubstringHammingDistance(std::string query, std::string candidate, int startQ, int lengthQ, int startC, int lengthC)
+double SubstringHammingDistance(std::string_view query, std::string_view candidate, int startQ, int lengthQ, int startC, int lengthC)
 {
 	//Generate bitvector substring
 	std::bitset<53> bsSub1; //TODO: allow for variable alphabet size
 	for (int i = 0; i < lengthC; i++)
 	{
-		int pos = CharacterIndex(candidate[startC + i]);
+		int pos = candidate[startC + i];
 		bsSub1[pos] = true;
 	}
 	//Generate bitvectors substrings in range
@@ -133,7 +135,7 @@ double SubstringHammingDistance(std::string query, std::string candidate, int st
 		std::bitset<53> bsSub2; //TODO: allow for variable alphabet size
 		for (int j = 0; j < lengthC; j++)
 		{
-			int pos = CharacterIndex(query[startQ + i + j]);
+			int pos = query[startQ + i + j];
 			bsSub2[pos] = true;
 		}
 		std::bitset<53> difference = bsSub1 ^ bsSub2; //TODO: allow for variable alphabet size
@@ -148,5 +150,5 @@ double SubstringHammingDistance(std::string query, std::string candidate, int st
 
 bool CompareLength(Entry i, Entry j)
 {
-	return (i.sequence.length() < j.sequence.length());
+	return (i.length < j.length);
 }
\ No newline at end of file
@@ -3,11 +3,11 @@
 */
 
 #pragma once
-#include<string>
+#include<string_view>
 #include "Result.h"
 #include "Entry.h"
 
-int LengthAwareED(std::string query, std::string candidate, int startQ, int lengthQ, int startC, int lengthC, int threshold);
-int SubstringEditDistance(std::string query, std::string candidate, int startQ, int lengthQ, int startC, int lengthC);
-double SubstringHammingDistance(std::string query, std::string candidate, int startQ, int lengthQ, int startC, int lengthC);
+int LengthAwareED(std::string_view query, std::string_view candidate, int startQ, int lengthQ, int startC, int lengthC, int threshold, long long* cells = nullptr); //cells: adds the evaluated band cells
+int SubstringEditDistance(std::string_view query, std::string_view candidate, int startQ, int lengthQ, int startC, int lengthC);
+double SubstringHammingDistance(std::string_view query, std::string_view candidate, int startQ, int lengthQ, int startC, int lengthC);
 bool CompareLength(Entry i, Entry j);
\ No newline at end of file
@@ -0,0 +1,64 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include "Result.h"
+#include <algorithm>
+#include <vector>
+
+//Bounded selection of the k best results: heap of the current k best with the worst on top, O(N log k) instead of sorting N results.
+//Ties are broken on entry ID so the selection does not depend on the order results are pushed in (threads)
+class TopK
+{
+private:
+	//Variables
+	int k;
+	bool lowerIsBetter; //Distances (ED, Jaccard distance) or scores (alignments)
+	std::vector<Result> heap;
+	//Methods
+	bool Better(const Result& a, const Result& b) const
+	{
+		if (lowerIsBetter ? (b < a) : (a < b))
+			return true;
+		if (lowerIsBetter ? (a < b) : (b < a))
+			return false;
+		return a.id < b.id;
+	}
+public:
+	//Methods
+	TopK(int k, bool lowerIsBetter)
+	{
+		this->k = std::max(k, 0);
+		this->lowerIsBetter = lowerIsBetter;
+		heap.reserve(this->k);
+	}
+	void Push(const Result& result)
+	{
+		auto better = [this](const Result& a, const Result& b) { return Better(a, b); };
+		if (heap.size() < (size_t)k)
+		{
+			heap.push_back(result);
+			std::push_heap(heap.begin(), heap.end(), better);
+		}
+		else if (k > 0 && Better(result, heap.front()))
+		{
+			std::pop_heap(heap.begin(), heap.end(), better);
+			heap.back() = result;
+			std::push_heap(heap.begin(), heap.end(), better);
+		}
+	}
+	void Merge(const TopK& other)
+	{
+		for (const Result& result : other.heap)
+			Push(result);
+	}
+	std::vector<Result> Results()
+	{
+		//Best first, the selection is emptied
+		std::sort_heap(heap.begin(), heap.end(), [this](const Result& a, const Result& b) { return Better(a, b); });
+		std::vector<Result> results;
+		results.swap(heap);
+		return results;
+	}
+};
\ No newline at end of file
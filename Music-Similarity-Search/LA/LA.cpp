@@ -3,22 +3,20 @@
 */
 
 #include "LA.h"
+#include "../General/QueryBlock.h"
 #include "../General/Scoring.h"
-#include <iostream>
 #include <string>
 #include <vector>
 #include <algorithm>
-#include <ctime>
 
 //Algorithms and code based on:
 // - Smith, Temple F., and Michael S. Waterman. "Identification of common molecular subsequences." Journal of molecular biology 147.1 (1981): 195-197.
 // - Gotoh, Osamu. "An improved algorithm for matching biological sequences." Journal of molecular biology 162.3 (1982): 705-708.
 // - Hirschberg, Daniel S. "A linear space algorithm for computing maximal common subsequences." Communications of the ACM 18.6 (1975): 341-343.
 
-LA::LA(Database* db, int k)
+LA::LA(const Database* db)
 {
 	this->db = db;
-	this->k = k;
 
 	//Construct substitution matrix
 	for (int i = 0; i < 53; i++)
@@ -27,7 +25,7 @@ LA::LA(Database* db, int k)
 }
 
 //Based on Smith-Waterman, Gotoh and Hirschberg algorithms
-int LA::SmithWaterman(std::string query, std::string candidate)
+int LA::SmithWaterman(std::string_view query, std::string_view candidate)
 {
 	std::vector<std::vector<int>> Ix;
 	std::vector<std::vector<int>> Iy;
@@ -44,8 +42,8 @@ int LA::SmithWaterman(std::string query, std::string candidate)
 	for (int i = 1; i <= query.size(); i++)
 	{
 		B[0][i] = 0;
-		Ix[0][i] = -INFINITY;
-		Iy[0][i] = -INFINITY;
+		Ix[0][i] = MINSCORE;
+		Iy[0][i] = MINSCORE;
 	}
 
 	int d = 2; //Gap opening cost
@@ -60,12 +58,12 @@ int LA::SmithWaterman(std::string query, std::string candidate)
 			if (j == 0)
 			{
 				B[1][j] = 0; //Best values
-				Ix[1][j] = -INFINITY;
-				Iy[1][j] = -INFINITY;
+				Ix[1][j] = MINSCORE;
+				Iy[1][j] = MINSCORE;
 			}
 			else
 			{
-				int M = B[0][j - 1] + substitutionMatrix[CharacterIndex(candidate[i])][CharacterIndex(query[j - 1])];
+				int M = B[0][j - 1] + substitutionMatrix[candidate[i]][query[j - 1]];
 				B[1][j] = clamp(std::max({ Ix[0][j], Iy[1][j - 1],  M }));
 				Ix[1][j] = clamp(std::max((M - d), (Ix[0][j] - e)));
 				Iy[1][j] = clamp(std::max((M - d), (Iy[1][j - 1] - e)));
@@ -81,29 +79,24 @@ int LA::SmithWaterman(std::string query, std::string candidate)
 	return max;
 }
 
-std::vector<Result> LA::SearchSequence(std::string query)
+void LA::ScanShard(const std::vector<std::string_view>& queries, const std::vector<const QueryState*>& states, int begin, int end, std::vector<TopK>& tops)
 {
-#pragma region Searching
-	std::vector<Result> result(db->db.size());
-	std::clock_t start = std::clock();
-#pragma omp parallel for
-	for (int i = 0; i < db->db.size(); i++)
+	//Queries in blocks of QueryBlock::LANES: every entry is loaded once and aligned against a whole block in one pass
+	std::vector<QueryBlock> blocks;
+	for (int first = 0; first < queries.size(); first += QueryBlock::LANES)
+		blocks.push_back(QueryBlock(queries, first, std::min(first + QueryBlock::LANES, (int)queries.size()), substitutionMatrix));
+	int scores[QueryBlock::LANES];
+	for (int i = begin; i < end; i++)
 	{
-		Entry dbentry = db->db[i];
-		std::string entry = dbentry.sequence;
-		double score = SmithWaterman(query, entry);
-		result[i] = Result(dbentry.index, score, true);
+		std::string_view entry = db->Sequence(db->Get(i));
+		for (int b = 0; b < blocks.size(); b++)
+		{
+			if (blocks[b].Size() == 1) //A single query doesn't fill the lanes
+				scores[0] = SmithWaterman(queries[b * QueryBlock::LANES], entry);
+			else
+				blocks[b].Local(entry, scores);
+			for (int j = 0; j < blocks[b].Size(); j++)
+				tops[b * QueryBlock::LANES + j].Push(Result(i, scores[j], true));
+		}
 	}
-	double duration = (std::clock() - start) / (CLOCKS_PER_SEC / 1000);
-	std::cout << ";;"; //2 x empty
-	std::cout << duration << ";"; //Searching
-#pragma endregion
-
-#pragma region Sorting results
-	start = std::clock();
-	std::sort(result.begin(), result.end());
-	duration = (std::clock() - start) / (CLOCKS_PER_SEC / 1000);
-	std::cout << duration << ";\n"; //Sorting
-#pragma endregion
-	return result;
-}
+}
\ No newline at end of file
@@ -7,12 +7,17 @@
 
 class LA : public SimilaritySearch
 {
+	friend class KernelBenchmark; //Micro-benchmarks of the private kernels
+	friend class SelfTest; //QueryBlock::Local against the scalar kernel
 private:
-	int k;
 	int substitutionMatrix[53][53];
-	int SmithWaterman(std::string query, std::string candidate);
+	int SmithWaterman(std::string_view query, std::string_view candidate); //Reference for QueryBlock::Local, one query at a time
+protected:
+	bool Scans() override { return true; }
+	bool LowerIsBetter() override { return false; }
+	void ScanShard(const std::vector<std::string_view>& queries, const std::vector<const QueryState*>& states, int begin, int end, std::vector<TopK>& tops) override;
 public:
 	LA() {}
-	LA(Database* db, int k);
-	std::vector<Result> SearchSequence(std::string query) override;
+	LA(const Database* db);
+	const char* Name() override { return "LA"; }
 };
\ No newline at end of file
@@ -5,16 +5,14 @@
 #include "Music-Similarity-Search.h"
 #include <iostream>
 #include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include <string>
 #include <fstream>
 #include <vector>
-#include <ctime>
 #include "stdlib.h"
 #include "stdio.h"
 #include "string.h"
-#include "windows.h"
-#include "psapi.h"
-//TODO: add k to algorithms
 
 //VARIABLES
 int k = 100;
@@ -22,6 +20,8 @@ int EDthreshold;
 //MAW
 int MAWmin = 4;
 int MAWmax = 8;
+int MAWbands = 16;
+int MAWrows = 4;
 //BLAST
 int BLT = 4;
 int BLA = 10;
@@ -32,45 +32,11 @@ int PASSchain;
 //PIVOTAL
 int PIVq;
 int PIVchain;
+//Scalability latency
+int concurrency = 1;
+int warmRuns = 2;
 
 //FUNCTIONS
-struct GroundTruth
-{
-	std::string query;
-	std::string result;
-	GroundTruth() {};
-	GroundTruth(std::string query, std::string result)
-	{
-		this->query = query;
-		this->result = result;
-	}
-};
-
-std::vector<GroundTruth> QueryList(std::string name)
-{
-	std::vector<GroundTruth> list;
-	std::fstream file;
-	file.open(name, std::ios::in);
-	if (file.is_open())
-	{
-		std::string line;
-		while (std::getline(file, line))
-		{
-			int j = 0;
-			while (line[j] != '\t')
-				j++;
-			int j2 = j + 1;
-			while (line[j2] != '\t')
-				j2++;
-			j2 = j2 - (j + 1);
-			std::string query = line.substr(0, j);
-			std::string result = line.substr(j + 1, j2);
-			list.push_back(GroundTruth(query, result));
-		}
-	}
-	return list;
-}
-
 bool getBool(char c)
 {
 	if (c == '0')
@@ -78,6 +44,19 @@ bool getBool(char c)
 	return true;
 }
 
+void ConvertDatabase(std::string name)
+{
+	long long start = Metrics::Now();
+	Database database(name + ".txt");
+	if (database.Size() == 0 || !database.Save(name + ".db"))
+	{
+		std::cout << "Could not convert " << name << ".txt\n";
+		return;
+	}
+	double duration = (Metrics::Now() - start) / 1000000.0;
+	std::cout << "Converted " << name << ".txt, entries= " << database.Size() << ", time= " << duration << "ms\n";
+}
+
 double StandardDeviation(std::vector<double> array, double mean, int nr)
 {
 	double variance = 0;
@@ -118,19 +97,23 @@ void QueryRetrieval(SimilaritySearch* ss, std::string algorithm, std::vector<std
 		double maxScore = DBL_MIN;
 
 		//Retrieval
-		std::clock_t start = std::clock();
+		long long start = Metrics::Now();
 		int nrOfQueries = list.size();
 		std::ofstream file;
 		file.open("Retrieval performance " + algorithm + " " + task + ".csv");
 		if (file.is_open())
 		{
+			std::vector<std::string> queries;
+			for (int j = 0; j < nrOfQueries; j++)
+				queries.push_back(list[j].query);
+			std::vector<std::vector<Result>> results = ss->SearchBatchID(queries, ss->db->Size()); //Full ranking for rank statistics
 			for (int j = 0; j < nrOfQueries; j++)
 			{
 				GroundTruth current = list[j];
 				std::string query = current.query;
 				std::string truth = current.result;
-				std::vector<Result> result = ss->SearchSequenceID(query);
-				auto it = std::find(result.begin(), result.end(), truth); //Find truth in result list
+				std::vector<Result>& result = results[j];
+				auto it = std::find(result.begin(), result.end(), ss->db->Find(truth)); //Find truth in result list
 				int rank = std::distance(result.begin(), it) + 1;
 				if (rank < minRank)
 					minRank = rank;
@@ -149,7 +132,7 @@ void QueryRetrieval(SimilaritySearch* ss, std::string algorithm, std::vector<std
 			}
 
 			//Statistics query time
-			double duration = (std::clock() - start) / (CLOCKS_PER_SEC / 1000);
+			double duration = (Metrics::Now() - start) / 1000000.0;
 			double avgQueryTime = duration / nrOfQueries;
 			file << "Mean query time;\n";
 			file << avgQueryTime << ";\n";
@@ -170,7 +153,7 @@ void QueryRetrieval(SimilaritySearch* ss, std::string algorithm, std::vector<std
 
 void RetrievalPerformance(std::string algorithmBools, std::string lists)
 {
-	Database* database = new Database("emo.txt");
+	Database* database = new Database(DatabaseFile("emo"));
 	std::vector<std::vector<GroundTruth>> querylists;
 	if (getBool(lists[0]))
 		querylists.push_back(QueryList("duplicates.txt"));
@@ -181,39 +164,39 @@ void RetrievalPerformance(std::string algorithmBools, std::string lists)
 
 	if (getBool(algorithmBools[0]))
 	{
-		std::cout << "Starting SSMAW, database size= " << database->db.size() << "\n";
-		SSMAW* MinimalAbsentWordSS = new SSMAW(database, MAWmin, MAWmax, k); //min, max
+		std::cout << "Starting SSMAW, database size= " << database->Size() << "\n";
+		SSMAW* MinimalAbsentWordSS = new SSMAW(database, MAWmin, MAWmax, 0, 0, "emo SSMAW.idx"); //min, max, no LSH, stored index
 		QueryRetrieval(MinimalAbsentWordSS, "MAW", querylists);
 		delete MinimalAbsentWordSS;
 	}
 
 	if (getBool(algorithmBools[1]))
 	{
-		std::cout << "Starting ED, database size= " << database->db.size() << "\n";
-		ED* EditDistanceSS = new ED(database, k);
+		std::cout << "Starting ED, database size= " << database->Size() << "\n";
+		ED* EditDistanceSS = new ED(database);
 		QueryRetrieval(EditDistanceSS, "ED", querylists);
 		delete EditDistanceSS;
 	}
 
 	if (getBool(algorithmBools[2]))
 	{
-		std::cout << "Starting GA, database size= " << database->db.size() << "\n";
-		GA* GlobalAlignmentSS = new GA(database, k);
+		std::cout << "Starting GA, database size= " << database->Size() << "\n";
+		GA* GlobalAlignmentSS = new GA(database);
 		QueryRetrieval(GlobalAlignmentSS, "GA", querylists);
 		delete GlobalAlignmentSS;
 	}
 
 	if (getBool(algorithmBools[3]))
 	{
-		std::cout << "Starting LA, database size= " << database->db.size() << "\n";
-		LA* LocalAlignmentSS = new LA(database, k);
+		std::cout << "Starting LA, database size= " << database->Size() << "\n";
+		LA* LocalAlignmentSS = new LA(database);
 		QueryRetrieval(LocalAlignmentSS, "LA", querylists);
 		delete LocalAlignmentSS;
 	}
 
 	if (getBool(algorithmBools[4]))
 	{
-		std::cout << "Starting BLAST, database size= " << database->db.size() << "\n";
+		std::cout << "Starting BLAST, database size= " << database->Size() << "\n";
 		BLAST* BasicLocalAlignmentSS = new BLAST(database, BLT, BLA, BLX, BLq); //T, A, X, q
 		QueryRetrieval(BasicLocalAlignmentSS, "BLAST", querylists);
 		delete BasicLocalAlignmentSS;
@@ -221,40 +204,135 @@ void RetrievalPerformance(std::string algorithmBools, std::string lists)
 
 	if (getBool(algorithmBools[5]))
 	{
-		std::cout << "Starting PassJoin, database size= " << database->db.size() << "\n";
-		PassJoin* PassJoinSS = new PassJoin(database, EDthreshold, PASSchain);
+		std::cout << "Starting PassJoin, database size= " << database->Size() << "\n";
+		PassJoin* PassJoinSS = new PassJoin(database, EDthreshold, PASSchain, "emo PassJoin.idx");
 		QueryRetrieval(PassJoinSS, "PassJoin", querylists);
 		delete PassJoinSS;
 	}
 
 	if (getBool(algorithmBools[6]))
 	{
-		std::cout << "Starting PIVOTAL, database size= " << database->db.size() << "\n";
-		PivotalSearch* PivotalSS = new PivotalSearch(database, PIVq, EDthreshold, PIVchain);
+		std::cout << "Starting PIVOTAL, database size= " << database->Size() << "\n";
+		PivotalSearch* PivotalSS = new PivotalSearch(database, PIVq, EDthreshold, PIVchain, "emo PIVOTAL.idx");
 		QueryRetrieval(PivotalSS, "PIVOTAL", querylists);
 		delete PivotalSS;
 	}
 	delete database;
 }
 
+//APPROXIMATION EXPERIMENTS
+void ApproximationPerformance(std::string lists)
+{
+	Database* database = new Database(DatabaseFile("emo"));
+	std::vector<GroundTruth> queryList;
+	std::vector<std::string> names{ "duplicates.txt", "same_music.txt", "relevant.txt" };
+	for (int i = 0; i < names.size(); i++)
+	{
+		if (getBool(lists[i]))
+		{
+			std::vector<GroundTruth> list = QueryList(names[i]);
+			queryList.insert(queryList.end(), list.begin(), list.end());
+		}
+	}
+
+	std::cout << "Starting SSMAW approximation, database size= " << database->Size() << "\n";
+	SSMAW* MinimalAbsentWordSS = new SSMAW(database, MAWmin, MAWmax, MAWbands, MAWrows, "emo SSMAW LSH.idx"); //min, max, bands, rows, stored index
+	std::ofstream file;
+	file.open("Approximation performance MAW.csv");
+	if (file.is_open())
+	{
+		file << "Probed bands;Recall exact top k;Truth found;Mean query time;\n";
+		std::vector<std::vector<Result>> exact;
+		for (int probe = 0; probe <= MAWbands; probe = (probe == 0) ? 1 : probe * 2) //0 = exact search
+		{
+			MinimalAbsentWordSS->SetProbeBands(probe);
+			double sumRecall = 0;
+			int found = 0;
+			long long start = Metrics::Now();
+			for (int i = 0; i < queryList.size(); i++)
+			{
+				std::vector<Result> result = MinimalAbsentWordSS->SearchSequenceID(queryList[i].query, k);
+				if (probe == 0)
+					exact.push_back(result);
+				//Recall = fraction of the exact top k that is also returned by the approximate search
+				int common = 0;
+				for (int j = 0; j < exact[i].size(); j++)
+					if (std::find(result.begin(), result.end(), exact[i][j].id) != result.end())
+						common++;
+				sumRecall += exact[i].empty() ? 1 : (double)common / exact[i].size();
+				if (std::find(result.begin(), result.end(), database->Find(queryList[i].result)) != result.end())
+					found++;
+			}
+			double duration = (Metrics::Now() - start) / 1000000.0;
+			file << probe << ";" << sumRecall / queryList.size() << ";" << (double)found / queryList.size() << ";" << duration / queryList.size() << ";\n";
+		}
+	}
+	file.close();
+	delete MinimalAbsentWordSS;
+	delete database;
+}
+
 //SCALABILITY EXPERIMENTS
-void ScalabilityTest(SimilaritySearch* ss, std::vector<GroundTruth>& queryList, std::string& line)
+void LatencyTest(SimilaritySearch* ss, std::vector<GroundTruth>& queryList, std::ofstream& latency, int size)
 {
-	std::clock_t start = std::clock();
+	//Single query latencies, before the batch: the cold run directly follows the index construction
+	std::vector<std::string> queries;
+	for (int i = 0; i < queryList.size(); i++)
+		queries.push_back(queryList[i].query);
+	LatencyReport report = MeasureLatency(ss, queries, k, concurrency, warmRuns);
+	latency << size << ";" << ss->Name() << ";" << concurrency << ";" << report.Line() << "\n";
+}
 
+void ScalabilityTest(SimilaritySearch* ss, std::vector<GroundTruth>& queryList, std::string& line)
+{
+	std::vector<std::string> queries;
 	for (int i = 0; i < queryList.size(); i++)
-		ss->SearchSequenceID(queryList[i].query);
-	double duration = ((std::clock() - start) / (CLOCKS_PER_SEC / 1000)) / queryList.size();
-	line += std::to_string((int)duration) + ";";
+		queries.push_back(queryList[i].query);
+	long long start = Metrics::Now();
+	ss->SearchBatchID(queries, k);
+	double duration = ((Metrics::Now() - start) / 1000000.0) / queryList.size();
+	line += std::to_string(duration) + ";";
+}
+
+void FilterStatistics(std::ofstream& filters, std::ofstream& queries, int size, std::string algorithm, FilterLog& log)
+{
+	//Aggregate and per query filter statistics of PassJoin and PIVOTAL
+	filters << size << ";" << algorithm << ";" << log.Total().Line() << "\n";
+	for (const FilterStats& query : log.Queries())
+		queries << size << ";" << algorithm << ";" << query.Line() << "\n";
+}
+
+void MemoryStatistics(std::ofstream& memory, int size, SimilaritySearch* ss)
+{
+	//Bytes per structure of the database and the index
+	MemoryReport report = ss->Memory();
+	for (const auto& structure : report.structures)
+		memory << size << ";" << ss->Name() << ";" << structure.first << ";" << structure.second << "\n";
+	memory << size << ";" << ss->Name() << ";Total;" << report.Total() << "\n";
 }
 
 void Scalability(std::string algorithmBools, std::string queryFile)
 {
 	std::ofstream file;
 	file.open("Scalability.csv");
+	std::ofstream memory;
+	memory.open("Scalability memory.csv");
+	memory << "Number of sequences;Algorithm;Structure;Bytes\n";
+	std::ofstream latency;
+	latency.open("Scalability latency.csv");
+	latency << "Number of sequences;Algorithm;Concurrency;" << LatencyReport::Header() << "\n";
+	std::ofstream filters;
+	std::ofstream filterQueries;
+	if (getBool(algorithmBools[5]) || getBool(algorithmBools[6]))
+	{
+		filters.open("Scalability filters.csv");
+		filterQueries.open("Scalability filters per query.csv");
+		filters << "Number of sequences;Algorithm;" << FilterStats::Header() << "\n";
+		filterQueries << "Number of sequences;Algorithm;" << FilterStats::Header() << "\n";
+	}
 	if (file.is_open())
 	{
-		std::clock_t startToFinish = std::clock();
+		long long startToFinish = Metrics::Now();
 		double duration;
 		file << "Number of sequences;";
 		std::vector<std::string> labels{ "SSMAW IndexSize;SSMAW;SSMAW IndexTime", "ED", "GA", "LA", "BLAST", "PassJoin IndexSize;PassJoin;PassJoin IndexTime", "Pivotal IndexSize;Pivotal;Pivotal IndexTime" };
@@ -269,16 +347,16 @@ void Scalability(std::string algorithmBools, std::string queryFile)
 		for (int i = 0; i < 10; i++)
 		{
 			int nr = i + 1;
-			Database* database = new Database("emo_" + std::to_string(nr) + "a.txt");
-			std::string line = std::to_string(database->db.size()) + ";";
+			Database* database = new Database(DatabaseFile("emo_" + std::to_string(nr) + "a"));
+			std::string line = std::to_string(database->Size()) + ";";
 
 			if (getBool(algorithmBools[0]))
 			{
-				std::cout << "Starting SSMAW, database size= " << database->db.size() << "\n";
-				SSMAW* MinimalAbsentWordSS = new SSMAW(database, MAWmin, MAWmax, k); //min, max
-				PROCESS_MEMORY_COUNTERS_EX pmc;
-				GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&pmc, sizeof(pmc));
-				line += std::to_string(pmc.PrivateUsage / 1000000) + ";";
+				std::cout << "Starting SSMAW, database size= " << database->Size() << "\n";
+				SSMAW* MinimalAbsentWordSS = new SSMAW(database, MAWmin, MAWmax); //min, max
+				line += std::to_string(CurrentMemory() / 1000000) + ";";
+				MemoryStatistics(memory, database->Size(), MinimalAbsentWordSS);
+				LatencyTest(MinimalAbsentWordSS, queryList, latency, database->Size());
 				ScalabilityTest(MinimalAbsentWordSS, queryList, line);
 				line += std::to_string(MinimalAbsentWordSS->indexTime) + ";";
 				delete MinimalAbsentWordSS;
@@ -286,67 +364,83 @@ void Scalability(std::string algorithmBools, std::string queryFile)
 
 			if (getBool(algorithmBools[1]))
 			{
-				std::cout << "Starting ED, database size= " << database->db.size() << "\n";
-				ED* EditDistanceSS = new ED(database, k);
+				std::cout << "Starting ED, database size= " << database->Size() << "\n";
+				ED* EditDistanceSS = new ED(database);
+				MemoryStatistics(memory, database->Size(), EditDistanceSS);
+				LatencyTest(EditDistanceSS, queryList, latency, database->Size());
 				ScalabilityTest(EditDistanceSS, queryList, line);
 				delete EditDistanceSS;
 			}
 
 			if (getBool(algorithmBools[2]))
 			{
-				std::cout << "Starting GA, database size= " << database->db.size() << "\n";
-				GA* GlobalAlignmentSS = new GA(database, k);
+				std::cout << "Starting GA, database size= " << database->Size() << "\n";
+				GA* GlobalAlignmentSS = new GA(database);
+				MemoryStatistics(memory, database->Size(), GlobalAlignmentSS);
+				LatencyTest(GlobalAlignmentSS, queryList, latency, database->Size());
 				ScalabilityTest(GlobalAlignmentSS, queryList, line);
 				delete GlobalAlignmentSS;
 			}
 
 			if (getBool(algorithmBools[3]))
 			{
-				std::cout << "Starting LA, database size= " << database->db.size() << "\n";
-				LA* LocalAlignmentSS = new LA(database, k);
+				std::cout << "Starting LA, database size= " << database->Size() << "\n";
+				LA* LocalAlignmentSS = new LA(database);
+				MemoryStatistics(memory, database->Size(), LocalAlignmentSS);
+				LatencyTest(LocalAlignmentSS, queryList, latency, database->Size());
 				ScalabilityTest(LocalAlignmentSS, queryList, line);
 				delete LocalAlignmentSS;
 			}
 
 			if (getBool(algorithmBools[4]))
 			{
-				std::cout << "Starting BLAST, database size= " << database->db.size() << "\n";
+				std::cout << "Starting BLAST, database size= " << database->Size() << "\n";
 				BLAST* BasicLocalAlignmentSS = new BLAST(database, BLT, BLA, BLT, BLq); //T, A, X, q
+				MemoryStatistics(memory, database->Size(), BasicLocalAlignmentSS);
+				LatencyTest(BasicLocalAlignmentSS, queryList, latency, database->Size());
 				ScalabilityTest(BasicLocalAlignmentSS, queryList, line);
 				delete BasicLocalAlignmentSS;
 			}
 
 			if (getBool(algorithmBools[5]))
 			{
-				std::cout << "Starting PassJoin, database size= " << database->db.size() << "\n";
+				std::cout << "Starting PassJoin, database size= " << database->Size() << "\n";
 				PassJoin* PassJoinSS = new PassJoin(database, EDthreshold, PASSchain);
-				PROCESS_MEMORY_COUNTERS_EX pmc;
-				GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&pmc, sizeof(pmc));
-				line += std::to_string(pmc.PrivateUsage / 1000000) + ";";
+				line += std::to_string(CurrentMemory() / 1000000) + ";";
+				MemoryStatistics(memory, database->Size(), PassJoinSS);
+				LatencyTest(PassJoinSS, queryList, latency, database->Size());
+				PassJoinSS->filterLog.Reset(); //Batch only
 				ScalabilityTest(PassJoinSS, queryList, line);
 				line += std::to_string(PassJoinSS->indexTime) + ";";
+				FilterStatistics(filters, filterQueries, database->Size(), "PassJoin", PassJoinSS->filterLog);
 				delete PassJoinSS;
 			}
 
 			if (getBool(algorithmBools[6]))
 			{
-				std::cout << "Starting PIVOTAL, database size= " << database->db.size() << "\n";
+				std::cout << "Starting PIVOTAL, database size= " << database->Size() << "\n";
 				PivotalSearch* PivotalSS = new PivotalSearch(database, PIVq, EDthreshold, PIVchain);
-				PROCESS_MEMORY_COUNTERS_EX pmc;
-				GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&pmc, sizeof(pmc));
-				line += std::to_string(pmc.PrivateUsage / 1000000) + ";";
+				line += std::to_string(CurrentMemory() / 1000000) + ";";
+				MemoryStatistics(memory, database->Size(), PivotalSS);
+				LatencyTest(PivotalSS, queryList, latency, database->Size());
+				PivotalSS->filterLog.Reset(); //Batch only
 				ScalabilityTest(PivotalSS, queryList, line);
 				line += std::to_string(PivotalSS->indexTime) + ";";
+				FilterStatistics(filters, filterQueries, database->Size(), "PIVOTAL", PivotalSS->filterLog);
 				delete PivotalSS;
 			}
 
 			file << line << "\n";
 			delete database;
 		}
-		duration = (std::clock() - startToFinish) / (CLOCKS_PER_SEC / 1000);
+		duration = (Metrics::Now() - startToFinish) / 1000000.0;
 		file << "Total time elapsed: " + std::to_string((int)duration) + "\n";
 	}
 	file.close();
+	memory.close();
+	latency.close();
+	filters.close();
+	filterQueries.close();
 }
 
 //MAIN
@@ -354,8 +448,27 @@ void Experiments()
 {
 	int mode;
 	std::cout << "Choose experiment music similarity search:\n";
-	std::cout << "0: Retrieval Performance, 1: Scalability, 2: Both\n";
+	std::cout << "0: Retrieval Performance, 1: Scalability, 2: Both, 3: SSMAW approximation, 4: Convert databases to binary\n";
 	std::cin >> mode;
+	if (mode == 4)
+	{
+		ConvertDatabase("emo");
+		for (int i = 1; i <= 10; i++)
+			ConvertDatabase("emo_" + std::to_string(i) + "a");
+		std::cout << "Finished\n";
+		return;
+	}
+	if (mode == 3)
+	{
+		std::string lists;
+		std::cout << "Choose which query lists to test:\n";
+		std::cout << "Enter string of 3 zeroes and ones (e.g. 111 for all query lists)\n";
+		std::cout << "In order: dupl, same, relv\n";
+		std::cin >> lists;
+		ApproximationPerformance(lists);
+		std::cout << "Finished\n";
+		return;
+	}
 	std::string algorithms;
 	std::cout << "Choose which algorithms to test:\n";
 	std::cout << "Enter string of 7 zeroes and ones (e.g. 1111111 for all algorithms)\n";
@@ -392,14 +505,60 @@ void Experiments()
 
 	//Experiment 2 - Scalability
 	if (mode == 1 || mode == 2)
+	{
+		std::cout << "Enter number of concurrent clients:\n";
+		std::cin >> concurrency;
 		Scalability(algorithms, "duplicates.txt");
+	}
 
 	std::cout << "Finished\n";
 	int end = 0;
 	std::cin >> end;
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+	if (argc > 1)
+	{
+		//Headless: config files and key=value overrides, in order
+		BenchmarkConfig config;
+		for (int i = 1; i < argc; i++)
+		{
+			std::string arg = argv[i];
+			size_t pos = arg.find('=');
+			bool ok = (pos == std::string::npos) ? config.Read(arg) : config.Set(arg.substr(0, pos), arg.substr(pos + 1));
+			if (!ok)
+			{
+				std::cout << "Invalid argument: " << arg << "\n";
+				return 1;
+			}
+		}
+		if (!config.metrics.empty() && !Metrics::Open(config.metrics))
+			std::cout << "Can't write metrics: " << config.metrics << "\n";
+		if (!config.trace.empty() && config.metrics.empty())
+			std::cout << "A trace needs a metrics file (metrics=<path>), no trace written\n";
+		else if (!config.trace.empty() && !Metrics::Trace(config.trace))
+			std::cout << "Can't write trace: " << config.trace << "\n";
+		bool ran;
+		if (config.mode == "kernels")
+			ran = KernelBenchmark::Run(config);
+		else if (config.mode == "scaling")
+			ran = RunScaling(config);
+		else if (config.mode == "generate")
+			ran = GenerateCorpus(config);
+		else if (config.mode == "pareto")
+			ran = RunPareto(config);
+		else if (config.mode == "tune")
+			ran = RunTuner(config);
+		else if (config.mode == "selftest")
+			ran = SelfTest::Run(config);
+		else
+			ran = RunBenchmark(config);
+		Metrics::Close();
+		return ran ? 0 : 1;
+	}
+	Metrics::Open("Metrics.csv"); //Per query phase timings of the experiments
 	Experiments();
+	Metrics::Close();
+	return 0;
 }
@@ -4,6 +4,14 @@
 
 #pragma once
 #include "General/SimilaritySearch.h"
+#include "General/Memory.h"
+#include "Benchmark/Benchmark.h"
+#include "Benchmark/Generator.h"
+#include "Benchmark/Kernels.h"
+#include "Benchmark/Pareto.h"
+#include "Benchmark/Scaling.h"
+#include "Benchmark/SelfTest.h"
+#include "Benchmark/Tuner.h"
 #include "BLAST/BLAST.h"
 #include "PassJoin/PassJoin.h"
 #include "LA/LA.h"
@@ -4,16 +4,19 @@
 
 #include "PivotalSearch.h"
 #include "../General/Tools.h"
-#include <iostream>
+#include "../General/BinaryFile.h"
+#include "../General/LengthView.h"
 #include <algorithm>
 #include <functional>
-#include <ctime>
 
 //Algorithms and code based on:
 // - Deng, Dong, Guoliang Li, and Jianhua Feng. "A pivotal prefix based filtering algorithm for string similarity search." Proceedings of the 2014 ACM SIGMOD international conference on Management of data. 2014.
 // - Qin, Jianbin, and Chuan Xiao. "Pigeonring: A principle for faster thresholded similarity search." arXiv preprint arXiv:1804.01614 (2018).
 
-PivotalSearch::PivotalSearch(Database* db, int q, int threshold, int chainLength)
+const char PIVOTALMAGIC[8] = { 'P', 'I', 'V', 'O', 'T', 'I', 'D', 'X' };
+const uint32_t PIVOTALVERSION = 2;
+
+PivotalSearch::PivotalSearch(const Database* db, int q, int threshold, int chainLength, std::string indexFile)
 {
 	this->db = db;
 	this->q = q;
@@ -21,11 +24,18 @@ PivotalSearch::PivotalSearch(Database* db, int q, int threshold, int chainLength
 	this->chainLength = chainLength;
 
 	//Indexing
-	std::clock_t start = std::clock();
-	Indexing();
-	double duration = (std::clock() - start) / (CLOCKS_PER_SEC / 1000);
-	indexTime = (int)duration;
-	std::cout << "Time elapsed indexing: " << duration << "\n";
+	Span span(Name(), Metrics::BUILDINDEX);
+	long long start = Metrics::Now();
+	if (indexFile.empty() || !Load(indexFile))
+	{
+		Indexing();
+		if (!indexFile.empty())
+			Save(indexFile);
+	}
+	for (int i = 0; i < db->Size(); i++)
+		lengths.push_back(db->Get(i).length);
+	std::sort(lengths.begin(), lengths.end());
+	indexTime = (int)((Metrics::Now() - start) / 1000000);
 }
 
 //Sorting orders
@@ -38,22 +48,23 @@ bool PositionOrdering(Qgram i, Qgram j)
 void PivotalSearch::CountFrequency()
 {
 	//For every qgram count frequency in the database
-	for (int i = 0; i < db->db.size(); i++)
+	for (int i = 0; i < db->Size(); i++)
 	{
-		std::string entry = db->db[i].sequence;
+		std::string_view entry = db->Sequence(db->Get(i));
 		for (int j = 0; j < entry.length() - q + 1; j++)
-			qgramFrequency[entry.substr(j, q)]++;
+			qgramFrequency[std::string(entry.substr(j, q))]++;
 	}
 }
 
-void PivotalSearch::GeneratePrefixPivotal(std::string entry, std::vector<Qgram>& prefix, std::vector<Qgram>& pivotal)
+void PivotalSearch::GeneratePrefixPivotal(std::string_view entry, std::vector<Qgram>& prefix, std::vector<Qgram>& pivotal)
 {
 	//Generate q-grams & sort by frequency
 	std::vector<Qgram> qgrams;
 	for (int i = 0; i < entry.length() - q + 1; i++)
 	{
-		std::string qgram = entry.substr(i, q);
-		qgrams.push_back(Qgram(qgram, qgramFrequency[qgram], i));
+		std::string qgram = std::string(entry.substr(i, q));
+		auto it = qgramFrequency.find(qgram);
+		qgrams.push_back(Qgram(qgram, (it == qgramFrequency.end()) ? 0 : (*it).second, i));
 	}
 	std::sort(qgrams.begin(), qgrams.end());
 
@@ -86,34 +97,154 @@ void PivotalSearch::GeneratePrefixPivotal(std::string entry, std::vector<Qgram>&
 void PivotalSearch::Indexing()
 {
 	//Count q-gram frequency (frequency counting and division into q-grams has been split to save memory)
-	std::sort(db->db.begin(), db->db.end(), CompareLength);
+	Span span(Name(), Metrics::FREQUENCIES);
 	CountFrequency();
+	span.Next(Metrics::POSTINGS); //Prefix and pivotal lists
 
-	//Iterate over db, generate prefixes and pivotals and create index
-	for (int i = 0; i < db->db.size(); i++)
+	//Iterate over db sorted on length, generate prefixes and pivotals and create index
+	LengthView view(db, false);
+	lastPrefixFrequency.resize(db->Size());
+	pivotals.resize(db->Size());
+	for (int i = 0; i < view.Size(); i++)
 	{
+		int id = view[i];
+		const Entry& entry = db->Get(id);
 		std::vector<Qgram> prefix;
 		std::vector<Qgram> pivotal;
-		GeneratePrefixPivotal(db->db[i].sequence, prefix, pivotal);
+		GeneratePrefixPivotal(db->Sequence(entry), prefix, pivotal);
 
 		for (int j = 0; j < prefix.size(); j++)
 		{
 			std::string qgram = prefix[j].s;
-			indexPrefixes[db->db[i].sequence.length()][qgram].push_back(PrefixEntry(i, prefix[j].pos));
+			indexPrefixes[entry.length][qgram].push_back(PrefixEntry(id, prefix[j].pos));
 		}
-		lastPrefixFrequency.push_back(prefix[prefix.size() - 1].frequency);
+		lastPrefixFrequency[id] = prefix[prefix.size() - 1].frequency;
 
 		for (int j = 0; j < pivotal.size(); j++)
 		{
 			std::string qgram = pivotal[j].s;
-			indexPivotals[db->db[i].sequence.length()][qgram].push_back(PivotalEntry(i, pivotal[j].pos, j));
+			indexPivotals[entry.length][qgram].push_back(PivotalEntry(id, pivotal[j].pos, j));
+		}
+		pivotals[id] = pivotal;
+	}
+}
+
+//Memory
+MemoryReport PivotalSearch::Memory()
+{
+	MemoryReport report = SimilaritySearch::Memory();
+	report.Add("Q-gram frequencies", HeapBytes(qgramFrequency));
+	report.Add("lastPrefixFrequency", HeapBytes(lastPrefixFrequency));
+	report.Add("Prefix index", HeapBytes(indexPrefixes));
+	report.Add("Pivotal index", HeapBytes(indexPivotals));
+	report.Add("Pivotals", HeapBytes(pivotals));
+	report.Add("Lengths", HeapBytes(lengths));
+	return report;
+}
+
+//Storage
+template <typename T>
+void WriteIndex(BinaryWriter& writer, const std::map<int, std::unordered_map<std::string, std::vector<T>>>& index)
+{
+	writer.Write<uint32_t>(index.size());
+	for (const auto& length : index)
+	{
+		writer.Write<int32_t>(length.first);
+		writer.Write<uint32_t>(length.second.size());
+		for (const auto& list : length.second)
+		{
+			writer.WriteString(list.first);
+			writer.WriteVector(list.second);
+		}
+	}
+}
+
+template <typename T>
+void ReadIndex(BinaryReader& reader, std::map<int, std::unordered_map<std::string, std::vector<T>>>& index)
+{
+	uint32_t nrOfLengths = reader.Read<uint32_t>();
+	for (uint32_t i = 0; i < nrOfLengths && reader.Good(); i++)
+	{
+		auto& lists = index[reader.Read<int32_t>()];
+		uint32_t nrOfLists = reader.Read<uint32_t>();
+		lists.reserve(nrOfLists);
+		for (uint32_t l = 0; l < nrOfLists && reader.Good(); l++)
+		{
+			std::string_view key = reader.ReadString();
+			reader.ReadVector(lists[std::string(key)]);
 		}
-		pivotals.push_back(pivotal);
 	}
 }
 
+bool PivotalSearch::Save(std::string name)
+{
+	//Q-gram frequencies, prefix and pivotal indexes
+	BinaryWriter writer(name, PIVOTALMAGIC, PIVOTALVERSION, db->Checksum(), { q, threshold, chainLength });
+	writer.Write<uint32_t>(qgramFrequency.size());
+	for (const auto& qgram : qgramFrequency)
+	{
+		writer.WriteString(qgram.first);
+		writer.Write<int32_t>(qgram.second);
+	}
+	writer.WriteVector(lastPrefixFrequency);
+	WriteIndex(writer, indexPrefixes);
+	WriteIndex(writer, indexPivotals);
+	for (const std::vector<Qgram>& pivotal : pivotals)
+	{
+		writer.Write<uint32_t>(pivotal.size());
+		for (const Qgram& qgram : pivotal)
+		{
+			writer.WriteString(qgram.s);
+			writer.Write<int32_t>(qgram.frequency);
+			writer.Write<int32_t>(qgram.pos);
+		}
+	}
+	return writer.Close();
+}
+
+bool PivotalSearch::Load(std::string name)
+{
+	BinaryReader reader(name, PIVOTALMAGIC, PIVOTALVERSION, db->Checksum(), { q, threshold, chainLength });
+	if (!reader.Good())
+		return false;
+	std::unordered_map<std::string, int> frequency;
+	std::vector<int> lastFrequency;
+	std::map<int, std::unordered_map<std::string, std::vector<PrefixEntry>>> prefixes;
+	std::map<int, std::unordered_map<std::string, std::vector<PivotalEntry>>> pivotalIndex;
+	std::vector<std::vector<Qgram>> entryPivotals(db->Size());
+	uint32_t nrOfQgrams = reader.Read<uint32_t>();
+	frequency.reserve(nrOfQgrams);
+	for (uint32_t i = 0; i < nrOfQgrams && reader.Good(); i++)
+	{
+		std::string qgram = std::string(reader.ReadString());
+		frequency[qgram] = reader.Read<int32_t>();
+	}
+	reader.ReadVector(lastFrequency);
+	ReadIndex(reader, prefixes);
+	ReadIndex(reader, pivotalIndex);
+	for (int i = 0; i < db->Size() && reader.Good(); i++)
+	{
+		uint32_t size = reader.Read<uint32_t>();
+		for (uint32_t j = 0; j < size && reader.Good(); j++)
+		{
+			std::string qgram = std::string(reader.ReadString());
+			int count = reader.Read<int32_t>();
+			int pos = reader.Read<int32_t>();
+			entryPivotals[i].push_back(Qgram(qgram, count, pos));
+		}
+	}
+	if (!reader.Good() || lastFrequency.size() != db->Size())
+		return false;
+	qgramFrequency.swap(frequency);
+	lastPrefixFrequency.swap(lastFrequency);
+	indexPrefixes.swap(prefixes);
+	indexPivotals.swap(pivotalIndex);
+	pivotals.swap(entryPivotals);
+	return true;
+}
+
 //Searching
-bool PivotalSearch::PigeonRing(std::string candidate, int pivotalNr, std::string query, std::vector<Qgram>& pivotal)
+bool PivotalSearch::PigeonRing(std::string_view candidate, int pivotalNr, std::string_view query, std::vector<Qgram>& pivotal)
 {
 	if (chainLength == 0) //Chain length 0 = off, chain length threshold + 1 = equal to alignment filter
 		return true;
@@ -143,7 +274,7 @@ bool PivotalSearch::PigeonRing(std::string candidate, int pivotalNr, std::string
 	return true;
 }
 
-bool PivotalSearch::AlignmentFilter(std::string query, std::string candidate, std::vector<Qgram>& pivotal)
+bool PivotalSearch::AlignmentFilter(std::string_view query, std::string_view candidate, std::vector<Qgram>& pivotal)
 {
 	//Alignment filter is worse than pigeonring for Pivotal
 	int errors = 0;
@@ -162,18 +293,20 @@ bool PivotalSearch::AlignmentFilter(std::string query, std::string candidate, st
 	return true;
 }
 
-std::vector<Result> PivotalSearch::SearchSequence(std::string query)
+std::vector<Result> PivotalSearch::SearchSequence(std::string_view query, int k)
 {
 #pragma region Initialization
-	std::clock_t startC = std::clock();
-	std::vector <Result> result;
-	std::vector<bool> checked = std::vector<bool>(db->db.size(), false);
-	double duration = (std::clock() - startC) / (CLOCKS_PER_SEC / 1000);
-	std::cout << duration << ";"; //Initialization
+	Span span(Name(), Metrics::INDEXQUERY);
+	TopK result(k, true);
+	FilterStats stats;
+	stats.queries = 1;
+	stats.symbols = query.length();
+	stats.lengthSurvivors = std::upper_bound(lengths.begin(), lengths.end(), (int)query.length() + threshold) - std::lower_bound(lengths.begin(), lengths.end(), (int)query.length() - threshold);
+	std::vector<bool> checked = std::vector<bool>(db->Size(), false);
 #pragma endregion
 
 #pragma region Searching
-	startC = std::clock();
+	span.Next(Metrics::SEARCH);
 	std::vector<Qgram> prefix;
 	std::vector<Qgram> pivotal;
 	GeneratePrefixPivotal(query, prefix, pivotal);
@@ -185,21 +318,38 @@ std::vector<Result> PivotalSearch::SearchSequence(std::string query)
 		auto endLength = indexPivotals.upper_bound((int)query.length() + threshold);
 		for (auto lengthIT = startLength; lengthIT != endLength; lengthIT++)
 		{
-			std::vector<PivotalEntry> entryList = (*lengthIT).second[pre];
+			auto listIT = (*lengthIT).second.find(pre);
+			stats.probes++;
+			if (listIT == (*lengthIT).second.end())
+				continue;
+			const std::vector<PivotalEntry>& entryList = (*listIT).second;
+			stats.hits++;
+			stats.candidates += entryList.size();
 			for (int j = 0; j < entryList.size(); j++)
 			{
-				PivotalEntry entry = entryList[j];																					//Pigeonhole: piv(entry) intersect pre(query) = non empty
-				if (!checked[entry.index]																							//Check if already checked
-					&& (prefix[prefix.size() - 1].frequency > lastPrefixFrequency[entry.index])										//last(pre(query)) > last(pre(entry))
-					&& abs(entry.pos - prefix[i].pos) <= threshold)																	//Q-gram position filter	
+				const PivotalEntry& entry = entryList[j];																					//Pigeonhole: piv(entry) intersect pre(query) = non empty
+				if (checked[entry.index])																							//Check if already checked
+					stats.checked++;
+				else if (!(prefix[prefix.size() - 1].frequency > lastPrefixFrequency[entry.index]))								//last(pre(query)) > last(pre(entry))
+					stats.orderRejected++;
+				else if (abs(entry.pos - prefix[i].pos) > threshold)																//Q-gram position filter
+					stats.positionRejected++;
+				else
 				{
-					if (PigeonRing(db->db[entry.index].sequence, entry.pivotalNr, query, pivotals[entry.index]))					//Pigeonring
+					std::string_view candidate = db->Sequence(db->Get(entry.index));
+					if (PigeonRing(candidate, entry.pivotalNr, query, pivotals[entry.index]))										//Pigeonring
 					{
-						int score = LengthAwareED(query, db->db[entry.index].sequence, 0, query.length(), 0, db->db[entry.index].sequence.length(), threshold);
+						int score = LengthAwareED(query, candidate, 0, query.length(), 0, candidate.length(), threshold);
+						stats.verifications++;
 						if (score <= threshold)
-							result.push_back(Result(db->db[entry.index].index, score, true));
+						{
+							result.Push(Result(entry.index, score, true));
+							stats.successes++;
+						}
 						checked[entry.index] = true;
 					}
+					else
+						stats.pigeonRingRejected++;
 				}
 			}
 		}
@@ -211,34 +361,48 @@ std::vector<Result> PivotalSearch::SearchSequence(std::string query)
 		auto endLength = indexPrefixes.upper_bound((int)query.length() + threshold);
 		for (auto lengthIT = startLength; lengthIT != endLength; lengthIT++)
 		{
-			std::vector<PrefixEntry> entryList = (*lengthIT).second[piv];
+			auto listIT = (*lengthIT).second.find(piv);
+			stats.probes++;
+			if (listIT == (*lengthIT).second.end())
+				continue;
+			const std::vector<PrefixEntry>& entryList = (*listIT).second;
+			stats.hits++;
+			stats.candidates += entryList.size();
 			for (int j = 0; j < entryList.size(); j++)
 			{
-				PrefixEntry entry = entryList[j];																//Pigeonhole: piv(query) intersect pre(entry) = non empty
-				if (!checked[entry.index]																		//Check if already checked
-					&& (prefix[prefix.size() - 1].frequency <= lastPrefixFrequency[entry.index])				//last(pre(query)) <= last(pre(entry))
-					&& abs(entry.pos - pivotal[i].pos) <= threshold)											//Q-gram position filter 
+				const PrefixEntry& entry = entryList[j];																//Pigeonhole: piv(query) intersect pre(entry) = non empty
+				if (checked[entry.index])																		//Check if already checked
+					stats.checked++;
+				else if (!(prefix[prefix.size() - 1].frequency <= lastPrefixFrequency[entry.index]))			//last(pre(query)) <= last(pre(entry))
+					stats.orderRejected++;
+				else if (abs(entry.pos - pivotal[i].pos) > threshold)											//Q-gram position filter
+					stats.positionRejected++;
+				else
 				{
-					if (PigeonRing(query, i, db->db[entry.index].sequence, pivotal))							//Pigeonring
+					std::string_view candidate = db->Sequence(db->Get(entry.index));
+					if (PigeonRing(query, i, candidate, pivotal))											//Pigeonring
 					{
-						int score = LengthAwareED(query, db->db[entry.index].sequence, 0, query.length(), 0, db->db[entry.index].sequence.length(), threshold);
+						int score = LengthAwareED(query, candidate, 0, query.length(), 0, candidate.length(), threshold);
+						stats.verifications++;
 						if (score <= threshold)
-							result.push_back(Result(db->db[entry.index].index, score, true));
+						{
+							result.Push(Result(entry.index, score, true));
+							stats.successes++;
+						}
 						checked[entry.index] = true;
 					}
+					else
+						stats.pigeonRingRejected++;
 				}
 			}
 		}
 	}
-	duration = (std::clock() - startC) / (CLOCKS_PER_SEC / 1000);
-	std::cout << ";" << duration << ";"; //Initialization
 #pragma endregion
 
 #pragma region Sorting results
-	startC = std::clock();
-	std::sort(result.rbegin(), result.rend());
-	duration = (std::clock() - startC) / (CLOCKS_PER_SEC / 1000);
-	std::cout << duration << ";\n"; //Sorting
+	span.Next(Metrics::SORT);
+	std::vector<Result> sorted = result.Results();
+	filterLog.Add(stats);
 #pragma endregion
-	return result;
+	return sorted;
 }
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "../General/SimilaritySearch.h"
+#include "../General/FilterStats.h"
 #include "Qgram.h"
 #include "IndexEntry.h"
 #include <map>
@@ -21,16 +22,22 @@ private:
 	std::map<int, std::unordered_map<std::string, std::vector<PrefixEntry>>> indexPrefixes;
 	std::map<int, std::unordered_map<std::string, std::vector<PivotalEntry>>> indexPivotals;
 	std::vector<std::vector<Qgram>> pivotals;
+	std::vector<int> lengths; //Sorted entry lengths, for the length filter statistics
 	//Methods
 	void CountFrequency();
-	void GeneratePrefixPivotal(std::string entry, std::vector<Qgram>& prefix, std::vector<Qgram>& pivotal);
+	void GeneratePrefixPivotal(std::string_view entry, std::vector<Qgram>& prefix, std::vector<Qgram>& pivotal);
 	void Indexing();
-	bool PigeonRing(std::string candidate, int pivotalNr, std::string query, std::vector<Qgram>& pivotal);
-	bool AlignmentFilter(std::string query, std::string candidate, std::vector<Qgram>& pivotal);
+	bool Load(std::string name);
+	bool PigeonRing(std::string_view candidate, int pivotalNr, std::string_view query, std::vector<Qgram>& pivotal);
+	bool AlignmentFilter(std::string_view query, std::string_view candidate, std::vector<Qgram>& pivotal);
 public:
 	//Methods
 	PivotalSearch() {};
-	PivotalSearch(Database* db, int q, int threshold, int chainLength);
-	std::vector<Result> SearchSequence(std::string query) override;
+	PivotalSearch(const Database* db, int q, int threshold, int chainLength, std::string indexFile = ""); //Index is loaded from indexFile if it matches, otherwise built and saved there
+	const char* Name() override { return "PIVOTAL"; }
+	std::vector<Result> SearchSequence(std::string_view query, int k) override;
+	MemoryReport Memory() override;
+	bool Save(std::string name);
 	int indexTime;
+	FilterLog filterLog; //Filter statistics of every query
 };
@@ -3,49 +3,52 @@
 */
 
 #include "PassJoin.h"
-#include "..\General\Tools.h"
-#include <iostream>
+#include "../General/Tools.h"
+#include "../General/BinaryFile.h"
+#include "../General/LengthView.h"
 #include <algorithm>
+#include <cmath>
 #include <iterator>
-#include <ctime>
 
 //Algorithms and code based on:
 // - Li, Guoliang, et al. "Pass-join: A partition-based method for similarity joins." arXiv preprint arXiv:1111.7171 (2011).
 // - Qin, Jianbin, and Chuan Xiao. "Pigeonring: A principle for faster thresholded similarity search." arXiv preprint arXiv:1804.01614 (2018).
 
-PassJoin::PassJoin(Database* db, int threshold, int chainLength)
+const char PASSJOINMAGIC[8] = { 'P', 'A', 'S', 'S', 'J', 'I', 'D', 'X' };
+const uint32_t PASSJOINVERSION = 2;
+
+PassJoin::PassJoin(const Database* db, int threshold, int chainLength, std::string indexFile)
 {
 	this->db = db;
 	this->threshold = threshold;
 	this->chainLength = chainLength;
 
 	//Indexing
-	std::clock_t start = std::clock();
-	Indexing();
-	double duration = (std::clock() - start) / (CLOCKS_PER_SEC / 1000);
-	indexTime = (int)duration;
-	std::cout << "Time elapsed indexing: " << duration << "\n";
+	Span span(Name(), Metrics::BUILDINDEX);
+	long long start = Metrics::Now();
+	if (indexFile.empty() || !Load(indexFile))
+	{
+		Indexing();
+		if (!indexFile.empty())
+			Save(indexFile);
+	}
+	for (int i = 0; i < db->Size(); i++)
+		lengths.push_back(db->Get(i).length);
+	std::sort(lengths.begin(), lengths.end());
+	indexTime = (int)((Metrics::Now() - start) / 1000000);
 }
 
 //Indexing
 void PassJoin::Indexing()
 {
-	std::sort(db->db.begin(), db->db.end(), CompareLength); //Sort on length
-	//Sort strings of same length on alphabetical order
-	auto it = db->db.begin();
-	auto it2 = db->db.begin() + 1;
-	while (it != db->db.end())
-	{
-		while (it2 != db->db.end() && (*it).sequence.length() == (*it2).sequence.length())
-			std::advance(it2, 1);
-		std::sort(it, it2);
-		it = it2;
-	}
+	Span span(Name(), Metrics::POSTINGS); //Segment lists
+	LengthView view(db, true); //Sort on length, strings of same length on alphabetical order
 	//Iterate over database & build index
 	int nrOfSegments = threshold + 1;
-	for (int i = 0; i < db->db.size(); i++)
+	for (int i = 0; i < view.Size(); i++)
 	{
-		std::string entry = db->db[i].sequence;
+		int id = view[i];
+		std::string_view entry = db->Sequence(db->Get(id));
 		int f = floor((double)entry.length() / nrOfSegments);
 		int c = ceil((double)entry.length() / nrOfSegments);
 		int k = entry.length() - f * nrOfSegments;
@@ -60,14 +63,73 @@ void PassJoin::Indexing()
 				segLength = f;
 			else
 				segLength = c;
-			index[entry.length()][j][entry.substr(pos, segLength)].push_back(i);
+			index[entry.length()][j][std::string(entry.substr(pos, segLength))].push_back(id);
 			pos += segLength;
 		}
 	}
 }
 
+//Memory
+MemoryReport PassJoin::Memory()
+{
+	MemoryReport report = SimilaritySearch::Memory();
+	report.Add("Segment index", HeapBytes(index));
+	report.Add("Lengths", HeapBytes(lengths));
+	return report;
+}
+
+//Storage
+bool PassJoin::Save(std::string name)
+{
+	BinaryWriter writer(name, PASSJOINMAGIC, PASSJOINVERSION, db->Checksum(), { threshold, chainLength });
+	writer.Write<uint32_t>(index.size());
+	for (const auto& length : index)
+	{
+		writer.Write<int32_t>(length.first);
+		for (const auto& segment : length.second)
+		{
+			writer.Write<uint32_t>(segment.size());
+			for (const auto& list : segment)
+			{
+				writer.WriteString(list.first);
+				writer.WriteVector(list.second);
+			}
+		}
+	}
+	return writer.Close();
+}
+
+bool PassJoin::Load(std::string name)
+{
+	BinaryReader reader(name, PASSJOINMAGIC, PASSJOINVERSION, db->Checksum(), { threshold, chainLength });
+	if (!reader.Good())
+		return false;
+	int nrOfSegments = threshold + 1;
+	std::map<int, std::vector<std::unordered_map<std::string, std::vector<int>>>> loaded;
+	uint32_t nrOfLengths = reader.Read<uint32_t>();
+	for (uint32_t i = 0; i < nrOfLengths && reader.Good(); i++)
+	{
+		auto& segments = loaded[reader.Read<int32_t>()];
+		segments.resize(nrOfSegments);
+		for (int j = 0; j < nrOfSegments && reader.Good(); j++)
+		{
+			uint32_t nrOfLists = reader.Read<uint32_t>();
+			segments[j].reserve(nrOfLists);
+			for (uint32_t l = 0; l < nrOfLists && reader.Good(); l++)
+			{
+				std::string_view key = reader.ReadString();
+				reader.ReadVector(segments[j][std::string(key)]);
+			}
+		}
+	}
+	if (!reader.Good())
+		return false;
+	index.swap(loaded);
+	return true;
+}
+
 //Searching
-bool PassJoin::PigeonRing(std::string candidate, int segmentNr, int segmentPos, std::string query, std::vector<double>& thresholds)
+bool PassJoin::PigeonRing(std::string_view candidate, int segmentNr, int segmentPos, std::string_view query, std::vector<double>& thresholds)
 {
 	if (chainLength == 0) //Chain length 0 = off, chain length threshold + 1 = equal to alignment filter
 		return true;
@@ -103,7 +165,7 @@ bool PassJoin::PigeonRing(std::string candidate, int segmentNr, int segmentPos,
 	return true;
 }
 
-bool PassJoin::AlignmentFilter(std::string candidate, std::string query)
+bool PassJoin::AlignmentFilter(std::string_view candidate, std::string_view query)
 {
 	int nrOfSegments = threshold + 1;
 	int f = floor((double)candidate.length() / nrOfSegments);
@@ -132,26 +194,34 @@ bool PassJoin::AlignmentFilter(std::string candidate, std::string query)
 	return true;
 }
 
-void PassJoin::Verification(std::string query, std::vector<int>& candidates, int entryPos, int entrySeg, int segLength, std::vector<double>& thresholds, std::vector<Result>& result, std::vector<bool>& checked)
+void PassJoin::Verification(std::string_view query, std::vector<int>& candidates, int entryPos, int entrySeg, int segLength, std::vector<double>& thresholds, TopK& result, std::vector<bool>& checked, FilterStats& stats)
 {
+	stats.candidates += candidates.size();
 	for (int i = 0; i < candidates.size(); i++)
 	{
 		if (!checked[candidates[i]]) //Only verify entries that haven't been verified yet
 		{
-			Entry dbCandidate = db->db[candidates[i]];
-			std::string candidate = dbCandidate.sequence;
+			std::string_view candidate = db->Sequence(db->Get(candidates[i]));
 			if (PigeonRing(candidate, entrySeg, entryPos + segLength, query, thresholds)) //Pigeonring filter -> try to find a prefix viable chain
 			{
 				int score = LengthAwareED(query, candidate, 0, query.length(), 0, candidate.length(), threshold); //Verify candidate, using expensive ED calculation
+				stats.verifications++;
 				if (score <= threshold)
-					result.push_back(Result(dbCandidate.index, score, true));
+				{
+					result.Push(Result(candidates[i], score, true));
+					stats.successes++;
+				}
 				checked[candidates[i]] = true;
 			}
+			else
+				stats.pigeonRingRejected++;
 		}
+		else
+			stats.checked++;
 	}
 }
 
-void PassJoin::SubstringSelection(std::string query, int pos, int segment, int segLength, int entryLength, int& start, int& end)
+void PassJoin::SubstringSelection(std::string_view query, int pos, int segment, int segLength, int entryLength, int& start, int& end)
 {
 	//Multi-match aware method
 	int delta = abs((int)query.length() - entryLength);
@@ -163,13 +233,17 @@ void PassJoin::SubstringSelection(std::string query, int pos, int segment, int s
 	end = std::min(maxL, maxR);
 }
 
-std::vector<Result> PassJoin::SearchSequence(std::string query)
+std::vector<Result> PassJoin::SearchSequence(std::string_view query, int k)
 {
 #pragma region Initialization
-	std::clock_t startC = std::clock();
+	Span span(Name(), Metrics::INDEXQUERY);
 	//Variables
-	std::vector <Result> result;
-	std::vector<bool> checked = std::vector<bool>(db->db.size(), false); //Inserted entries
+	TopK result(k, true);
+	FilterStats stats;
+	stats.queries = 1;
+	stats.symbols = query.length();
+	stats.lengthSurvivors = std::upper_bound(lengths.begin(), lengths.end(), (int)query.length() + threshold) - std::lower_bound(lengths.begin(), lengths.end(), (int)query.length() - threshold);
+	std::vector<bool> checked = std::vector<bool>(db->Size(), false); //Inserted entries
 	int minL = (*index.begin()).first; //Minimum length
 	int maxL = (*index.rbegin()).first; //Maximum length
 	//Pre calculate thresholds for pigeonring
@@ -178,12 +252,10 @@ std::vector<Result> PassJoin::SearchSequence(std::string query)
 	std::vector<double> thresholds;
 	for (int i = 1; i < chainLength; i++)
 		thresholds.push_back((double)(i + 1) * single);
-	double duration = (std::clock() - startC) / (CLOCKS_PER_SEC / 1000);
-	std::cout << duration << ";"; //Initialization
 #pragma endregion
 
 #pragma region Searching
-	startC = std::clock();
+	span.Next(Metrics::SEARCH);
 	auto startLength = index.lower_bound(std::max((int)query.length() - threshold, minL));
 	auto endLength = index.upper_bound(std::min((int)query.length() + threshold, maxL));
 	for (auto lengthIT = startLength; lengthIT != endLength; lengthIT++) //Length-based filter: only consider entries with possible lengths
@@ -197,23 +269,24 @@ std::vector<Result> PassJoin::SearchSequence(std::string query)
 			SubstringSelection(query, pos, i, segLength, currentLength, start, end); //Select substrings for pigeonhole filter
 			for (int j = start; j <= end; j++)
 			{
-				std::string substring = query.substr(j, segLength);
+				std::string substring = std::string(query.substr(j, segLength));
 				auto substringIT = (*lengthIT).second[i].find(substring); //Look for exact matches of substring
+				stats.probes++;
 				if (substringIT != (*lengthIT).second[i].end()) //Pigeonhole filter: if there is an exact match, entry is a candidate
-					Verification(query, (*substringIT).second, pos, i, segLength, thresholds, result, checked); //For candidates: verify
+				{
+					stats.hits++;
+					Verification(query, (*substringIT).second, pos, i, segLength, thresholds, result, checked, stats); //For candidates: verify
+				}
 			}
 			pos += segLength;
 		}
 	}
-	duration = (std::clock() - startC) / (CLOCKS_PER_SEC / 1000);
-	std::cout << ";" << duration << ";"; //Searching
 #pragma endregion
 
 #pragma region Sorting results
-	startC = std::clock();
-	std::sort(result.rbegin(), result.rend());
-	duration = (std::clock() - startC) / (CLOCKS_PER_SEC / 1000);
-	std::cout << duration << ";\n"; //Sorting
+	span.Next(Metrics::SORT);
+	std::vector<Result> sorted = result.Results();
+	filterLog.Add(stats);
 #pragma endregion
-	return result;
+	return sorted;
 }
@@ -4,6 +4,7 @@
 
 #pragma once
 #include "../General/SimilaritySearch.h"
+#include "../General/FilterStats.h"
 #include <map>
 #include <unordered_map>
 
@@ -14,15 +15,21 @@ private:
 	int threshold;
 	int chainLength;
 	std::map<int, std::vector<std::unordered_map<std::string, std::vector<int>>>> index;
+	std::vector<int> lengths; //Sorted entry lengths, for the length filter statistics
 	//Methods
 	void Indexing();
-	void SubstringSelection(std::string query, int pos, int segment, int segLength, int entryLength, int& start, int& end);
-	void Verification(std::string query, std::vector<int>& candidates, int entryPos, int entrySeg, int segLength, std::vector<double>& thresholds, std::vector<Result>& result, std::vector<bool>& checked);
-	bool PigeonRing(std::string candidate, int segmentNr, int segmentPos, std::string query, std::vector<double>& thresholds);
-	bool AlignmentFilter(std::string candidate, std::string query);
+	bool Load(std::string name);
+	void SubstringSelection(std::string_view query, int pos, int segment, int segLength, int entryLength, int& start, int& end);
+	void Verification(std::string_view query, std::vector<int>& candidates, int entryPos, int entrySeg, int segLength, std::vector<double>& thresholds, TopK& result, std::vector<bool>& checked, FilterStats& stats);
+	bool PigeonRing(std::string_view candidate, int segmentNr, int segmentPos, std::string_view query, std::vector<double>& thresholds);
+	bool AlignmentFilter(std::string_view candidate, std::string_view query);
 public:
 	PassJoin() {};
-	PassJoin(Database* db, int threshold, int chainLength);
-	std::vector<Result> SearchSequence(std::string query) override;
+	PassJoin(const Database* db, int threshold, int chainLength, std::string indexFile = ""); //Index is loaded from indexFile if it matches, otherwise built and saved there
+	const char* Name() override { return "PassJoin"; }
+	std::vector<Result> SearchSequence(std::string_view query, int k) override;
+	MemoryReport Memory() override;
+	bool Save(std::string name);
 	int indexTime;
+	FilterLog filterLog; //Filter statistics of every query
 };
\ No newline at end of file
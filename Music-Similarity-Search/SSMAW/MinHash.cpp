@@ -0,0 +1,132 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "MinHash.h"
+#include <algorithm>
+#include <functional>
+
+//Algorithms and code based on:
+// - Broder, Andrei Z. "On the resemblance and containment of documents." Proceedings. Compression and Complexity of SEQUENCES 1997. IEEE, 1997.
+// - Leskovec, Jure, Anand Rajaraman, and Jeffrey D. Ullman. "Mining of massive datasets." Cambridge university press, 2020. Chapter 3.
+
+MinHash::MinHash(int bands, int rows)
+{
+	this->bands = bands;
+	this->rows = rows;
+	buckets = std::vector<std::unordered_map<uint64_t, std::vector<int>>>(bands);
+}
+
+uint64_t Mix(uint64_t x)
+{
+	//SplitMix64 finalizer: derives independent hash functions from one string hash
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+void MinHash::Signature(const std::set<std::string>& MAWs, uint64_t* signature) const
+{
+	int size = bands * rows;
+	std::fill(signature, signature + size, UINT64_MAX);
+	for (const std::string& w : MAWs)
+	{
+		uint64_t h = std::hash<std::string>()(w);
+		for (int i = 0; i < size; i++)
+		{
+			uint64_t value = Mix(h + 0x9e3779b97f4a7c15ULL * (i + 1));
+			if (value < signature[i])
+				signature[i] = value;
+		}
+	}
+}
+
+uint64_t MinHash::BandHash(const uint64_t* signature, int band) const
+{
+	uint64_t h = band;
+	for (int r = 0; r < rows; r++)
+		h = Mix(h ^ signature[band * rows + r]);
+	return h;
+}
+
+void MinHash::Resize(int nrOfEntries)
+{
+	signatures.resize((size_t)nrOfEntries * bands * rows, UINT64_MAX);
+}
+
+void MinHash::SetEntry(int entry, const std::set<std::string>& MAWs)
+{
+	if (bands == 0) //Approximate search disabled
+		return;
+	Signature(MAWs, &signatures[(size_t)entry * bands * rows]);
+}
+
+void MinHash::BuildBuckets()
+{
+	if (bands == 0)
+		return;
+	int nrOfEntries = signatures.size() / (bands * rows);
+	for (int b = 0; b < bands; b++)
+	{
+		buckets[b].clear();
+		for (int i = 0; i < nrOfEntries; i++)
+		{
+			const uint64_t* signature = &signatures[(size_t)i * bands * rows];
+			if (signature[0] != UINT64_MAX) //Entries without MAWs can't be similar to anything
+				buckets[b][BandHash(signature, b)].push_back(i);
+		}
+	}
+}
+
+void MinHash::Insert(int entry, const std::set<std::string>& MAWs)
+{
+	//Add one entry to the signatures and buckets (entry = number of entries so far)
+	if (bands == 0)
+		return;
+	Resize(entry + 1);
+	SetEntry(entry, MAWs);
+	const uint64_t* signature = &signatures[(size_t)entry * bands * rows];
+	if (signature[0] != UINT64_MAX)
+		for (int b = 0; b < bands; b++)
+			buckets[b][BandHash(signature, b)].push_back(entry);
+}
+
+void MinHash::Write(BinaryWriter& writer) const
+{
+	writer.WriteVector(signatures);
+}
+
+void MinHash::Read(BinaryReader& reader)
+{
+	//Buckets are rebuilt from the signatures
+	reader.ReadVector(signatures);
+	if (reader.Good())
+		BuildBuckets();
+}
+
+void MinHash::Candidates(const std::set<std::string>& MAWs, int probeBands, std::vector<int>& candidates) const
+{
+	//Union of the buckets the query falls in, for the first probeBands bands (less bands = lower recall, faster)
+	std::vector<uint64_t> signature(bands * rows);
+	Signature(MAWs, signature.data());
+	for (int b = 0; b < std::min(probeBands, bands); b++)
+	{
+		auto it = buckets[b].find(BandHash(signature.data(), b));
+		if (it != buckets[b].end())
+			candidates.insert(candidates.end(), (*it).second.begin(), (*it).second.end());
+	}
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+}
+
+
+void MinHash::Memory(MemoryReport& report) const
+{
+	if (bands == 0)
+		return;
+	report.Add("MinHash signatures", HeapBytes(signatures));
+	report.Add("MinHash buckets", HeapBytes(buckets));
+}
\ No newline at end of file
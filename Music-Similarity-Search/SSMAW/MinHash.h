@@ -0,0 +1,41 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include "../General/BinaryFile.h"
+#include "../General/Memory.h"
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//MinHash signatures of MAW sets with banded locality sensitive hashing:
+//two sets with Jaccard index J share a band of r rows with probability J^r
+class MinHash
+{
+private:
+	//Variables
+	int bands = 0;
+	int rows = 0;
+	std::vector<uint64_t> signatures; //bands * rows minimum hashes per entry
+	std::vector<std::unordered_map<uint64_t, std::vector<int>>> buckets; //Per band: band hash -> entries
+	//Methods
+	uint64_t BandHash(const uint64_t* signature, int band) const;
+public:
+	//Methods
+	MinHash() {};
+	MinHash(int bands, int rows);
+	void Signature(const std::set<std::string>& MAWs, uint64_t* signature) const;
+	void Resize(int nrOfEntries);
+	void SetEntry(int entry, const std::set<std::string>& MAWs);
+	void BuildBuckets();
+	void Insert(int entry, const std::set<std::string>& MAWs);
+	void Candidates(const std::set<std::string>& MAWs, int probeBands, std::vector<int>& candidates) const;
+	void Write(BinaryWriter& writer) const;
+	void Read(BinaryReader& reader);
+	void Memory(MemoryReport& report) const;
+	int Bands() const { return bands; }
+	int Rows() const { return rows; }
+};
@@ -0,0 +1,273 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#include "PostingList.h"
+#include <cstring>
+#include <utility>
+
+//Algorithms and code based on:
+// - Lemire, Daniel, and Leonid Boytsov. "Decoding billions of integers per second through vectorization." Software: Practice and Experience 45.1 (2015): 1-29.
+
+//Bit packing
+int BitWidth(uint32_t value)
+{
+	int width = 0;
+	while (value != 0)
+	{
+		width++;
+		value >>= 1;
+	}
+	return width;
+}
+
+void PackBlock(const uint32_t* in, int width, uint32_t* out)
+{
+	//Value j goes to lane j % 4, every lane holds 32 values in width words -> all lanes use the same shifts
+	const int LANES = PostingList::LANES;
+	std::memset(out, 0, LANES * width * sizeof(uint32_t));
+	for (int i = 0; i < 32; i++)
+	{
+		int bit = i * width;
+		int word = bit / 32;
+		int shift = bit % 32;
+		for (int lane = 0; lane < LANES; lane++)
+		{
+			uint32_t value = in[i * LANES + lane];
+			out[word * LANES + lane] |= value << shift;
+			if (shift + width > 32)
+				out[(word + 1) * LANES + lane] |= value >> (32 - shift);
+		}
+	}
+}
+
+void UnpackBlock(const uint32_t* in, int width, uint32_t* out)
+{
+	const int LANES = PostingList::LANES;
+	if (width == 0)
+	{
+		std::memset(out, 0, PostingList::BLOCKSIZE * sizeof(uint32_t));
+		return;
+	}
+	uint32_t mask = (width == 32) ? 0xFFFFFFFF : ((1u << width) - 1);
+	for (int i = 0; i < 32; i++)
+	{
+		int bit = i * width;
+		int word = bit / 32;
+		int shift = bit % 32;
+		for (int lane = 0; lane < LANES; lane++) //Independent lanes -> vectorized by the compiler
+		{
+			uint32_t value = in[word * LANES + lane] >> shift;
+			if (shift + width > 32)
+				value |= in[(word + 1) * LANES + lane] << (32 - shift);
+			out[i * LANES + lane] = value & mask;
+		}
+	}
+}
+
+//Encoding
+void PostingList::Encode(std::vector<int>& entries)
+{
+	count = entries.size();
+	data.clear();
+	delta.clear();
+	int nrOfBlocks = count / BLOCKSIZE;
+	int previous = -1;
+	uint32_t gaps[BLOCKSIZE];
+	uint32_t packed[BLOCKSIZE];
+	for (int b = 0; b < nrOfBlocks; b++)
+	{
+		uint32_t all = 0;
+		for (int i = 0; i < BLOCKSIZE; i++)
+		{
+			int id = entries[b * BLOCKSIZE + i];
+			gaps[i] = id - previous - 1;
+			all |= gaps[i];
+			previous = id;
+		}
+		int width = BitWidth(all);
+		PackBlock(gaps, width, packed);
+		//Block header: last ID for skipping, bit width
+		size_t pos = data.size();
+		data.resize(pos + 5 + LANES * width * sizeof(uint32_t));
+		uint32_t last = previous;
+		std::memcpy(&data[pos], &last, 4);
+		data[pos + 4] = (uint8_t)width;
+		std::memcpy(&data[pos + 5], packed, LANES * width * sizeof(uint32_t));
+	}
+	//Variable byte tail
+	for (int i = nrOfBlocks * BLOCKSIZE; i < count; i++)
+	{
+		uint32_t gap = entries[i] - previous - 1;
+		previous = entries[i];
+		while (gap >= 128)
+		{
+			data.push_back((uint8_t)(gap | 128));
+			gap >>= 7;
+		}
+		data.push_back((uint8_t)gap);
+	}
+	data.shrink_to_fit();
+}
+
+//Decoding
+template <typename F>
+void PostingList::ForEach(F f) const
+{
+	int nrOfBlocks = count / BLOCKSIZE;
+	int previous = -1;
+	size_t pos = 0;
+	uint32_t packed[BLOCKSIZE];
+	uint32_t gaps[BLOCKSIZE];
+	for (int b = 0; b < nrOfBlocks; b++)
+	{
+		int width = data[pos + 4];
+		std::memcpy(packed, &data[pos + 5], LANES * width * sizeof(uint32_t));
+		UnpackBlock(packed, width, gaps);
+		for (int i = 0; i < BLOCKSIZE; i++)
+		{
+			previous += gaps[i] + 1;
+			f(previous);
+		}
+		pos += 5 + LANES * width * sizeof(uint32_t);
+	}
+	for (int i = nrOfBlocks * BLOCKSIZE; i < count; i++)
+	{
+		uint32_t gap = 0;
+		int shift = 0;
+		while (data[pos] & 128)
+		{
+			gap |= (uint32_t)(data[pos] & 127) << shift;
+			shift += 7;
+			pos++;
+		}
+		gap |= (uint32_t)data[pos] << shift;
+		pos++;
+		previous += gap + 1;
+		f(previous);
+	}
+	for (int id : delta)
+		f(id);
+}
+
+void PostingList::Decode(std::vector<int>& entries) const
+{
+	entries.reserve(entries.size() + count);
+	ForEach([&entries](int id) { entries.push_back(id); });
+}
+
+void PostingList::AddTo(std::vector<int>& score) const
+{
+	//Decode straight into the score accumulator
+	int* s = score.data();
+	ForEach([s](int id) { s[id]++; });
+}
+
+void PostingList::Count(const std::vector<int>& candidates, std::vector<int>& counts) const
+{
+	//counts[c]++ for every sorted candidate c in the list: blocks with a last ID below the next candidate are skipped without decoding
+	int nrOfBlocks = count / BLOCKSIZE;
+	int nrOfCandidates = candidates.size();
+	int c = 0;
+	int previous = -1;
+	size_t pos = 0;
+	uint32_t packed[BLOCKSIZE];
+	uint32_t gaps[BLOCKSIZE];
+	for (int b = 0; b < nrOfBlocks; b++)
+	{
+		if (c == nrOfCandidates)
+			return;
+		uint32_t last;
+		std::memcpy(&last, &data[pos], 4);
+		int width = data[pos + 4];
+		if (candidates[c] <= (int)last)
+		{
+			std::memcpy(packed, &data[pos + 5], LANES * width * sizeof(uint32_t));
+			UnpackBlock(packed, width, gaps);
+			int id = previous;
+			for (int i = 0; i < BLOCKSIZE && c < nrOfCandidates; i++)
+			{
+				id += gaps[i] + 1;
+				while (c < nrOfCandidates && candidates[c] < id)
+					c++;
+				if (c < nrOfCandidates && candidates[c] == id)
+				{
+					counts[c]++;
+					c++;
+				}
+			}
+		}
+		previous = last;
+		pos += 5 + LANES * width * sizeof(uint32_t);
+	}
+	for (int i = nrOfBlocks * BLOCKSIZE; i < count && c < nrOfCandidates; i++)
+	{
+		uint32_t gap = 0;
+		int shift = 0;
+		while (data[pos] & 128)
+		{
+			gap |= (uint32_t)(data[pos] & 127) << shift;
+			shift += 7;
+			pos++;
+		}
+		gap |= (uint32_t)data[pos] << shift;
+		pos++;
+		previous += gap + 1;
+		while (c < nrOfCandidates && candidates[c] < previous)
+			c++;
+		if (c < nrOfCandidates && candidates[c] == previous)
+		{
+			counts[c]++;
+			c++;
+		}
+	}
+	for (int i = 0; i < delta.size() && c < nrOfCandidates; i++)
+	{
+		while (c < nrOfCandidates && candidates[c] < delta[i])
+			c++;
+		if (c < nrOfCandidates && candidates[c] == delta[i])
+		{
+			counts[c]++;
+			c++;
+		}
+	}
+}
+
+//Compaction
+PostingList PostingList::Merge(const std::vector<bool>& removed, int& consumed) const
+{
+	//New list with the compressed IDs and the current delta segment, without removed entries
+	std::vector<int> entries;
+	entries.reserve(Size());
+	ForEach([&entries, &removed](int id)
+		{
+			if (!removed[id])
+				entries.push_back(id);
+		});
+	consumed = delta.size();
+	PostingList merged;
+	merged.Encode(entries);
+	return merged;
+}
+
+void PostingList::Replace(PostingList& merged, int consumed)
+{
+	//IDs appended after the merge started stay in the delta segment
+	merged.delta.assign(delta.begin() + consumed, delta.end());
+	*this = std::move(merged);
+}
+
+//Storage
+void PostingList::Write(BinaryWriter& writer) const
+{
+	writer.Write<int32_t>(count);
+	writer.WriteVector(data);
+	writer.WriteVector(delta);
+}
+
+void PostingList::Read(BinaryReader& reader)
+{
+	count = reader.Read<int32_t>();
+	reader.ReadVector(data);
+	reader.ReadVector(delta);
+}
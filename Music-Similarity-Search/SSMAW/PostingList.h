@@ -0,0 +1,47 @@
+/*
+	Written by Jelle Mulyadi, 2021
+*/
+
+#pragma once
+#include "../General/BinaryFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+int BitWidth(uint32_t value);
+void PackBlock(const uint32_t* in, int width, uint32_t* out); //BLOCKSIZE values of at most width bits -> LANES * width words
+void UnpackBlock(const uint32_t* in, int width, uint32_t* out);
+
+//Compressed posting list of sorted entry IDs:
+// - IDs are delta-encoded (gap - 1 to the previous ID)
+// - Full blocks of 128 gaps are bit-packed with one bit width per block, interleaved over 4 lanes (SIMD-BP128 layout)
+// - The remaining gaps (< 128) are stored as variable byte integers
+// - Entries added after compression go to an uncompressed delta segment until the next compaction
+class PostingList
+{
+public:
+	static const int BLOCKSIZE = 128;
+	static const int LANES = 4;
+private:
+	//Variables
+	int count = 0;
+	std::vector<uint8_t> data; //Per block: last ID (4 bytes), bit width (1 byte), 16 * width bytes of packed gaps. Followed by the variable byte tail
+	std::vector<int> delta; //Appended IDs, all larger than the compressed IDs
+	//Methods
+	template <typename F>
+	void ForEach(F f) const;
+public:
+	//Methods
+	void Encode(std::vector<int>& entries);
+	void Decode(std::vector<int>& entries) const;
+	void AddTo(std::vector<int>& score) const;
+	void Count(const std::vector<int>& candidates, std::vector<int>& counts) const;
+	void Append(int id) { delta.push_back(id); }
+	PostingList Merge(const std::vector<bool>& removed, int& consumed) const;
+	void Replace(PostingList& merged, int consumed);
+	void Write(BinaryWriter& writer) const;
+	void Read(BinaryReader& reader);
+	int Size() const { return count + delta.size(); }
+	int Pending() const { return delta.size(); }
+	size_t Bytes() const { return data.capacity() + delta.capacity() * sizeof(int); }
+};
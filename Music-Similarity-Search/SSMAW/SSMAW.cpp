@@ -8,33 +8,47 @@
 #include "../General/Result.h"
 #include "../General/Tools.h"
 #include <set>
-#include <iostream>
-#include <ctime>
 #include <vector>
 #include <algorithm>
 #include <bitset>
+#include <functional>
+#include <mutex>
 
 //Algorithms and code based on:
 // - Barton, Carl, et al. "Linear-time computation of minimal absent words using suffix array." BMC bioinformatics 15.1 (2014): 1-10.
 // - Crawford, Tim, Golnaz Badkobeh, and David Lewis. "Searching page-images of early music scanned with OMR: A scalable solution using minimal absent words." (2018): 233-239.
 
-SSMAW::SSMAW(Database* db, int min, int max, int nrOfResults)
+const char SSMAWMAGIC[8] = { 'S', 'S', 'M', 'A', 'W', 'I', 'D', 'X' };
+const uint32_t SSMAWVERSION = 2;
+
+SSMAW::SSMAW(const Database* db, int min, int max, int bands, int rows, std::string indexFile)
 {
 	this->db = db;
 	this->min = min;
 	this->max = max;
-	this->nrOfResults = nrOfResults;
+	if (bands > 0 && rows > 0) //MinHash signatures for the approximate search
+		signatures = MinHash(bands, rows);
 
 	//Indexing
-	std::clock_t start = std::clock();
-	Indexing();
-	double duration = (std::clock() - start) / (CLOCKS_PER_SEC / 1000);
-	indexTime = (int)duration;
-	std::cout << "Time elapsed indexing: " << duration << "\n";
+	Span span(Name(), Metrics::BUILDINDEX);
+	long long start = Metrics::Now();
+	if (indexFile.empty() || !Load(indexFile))
+	{
+		Indexing();
+		if (!indexFile.empty())
+			Save(indexFile);
+	}
+	indexTime = (int)((Metrics::Now() - start) / 1000000);
+}
+
+SSMAW::~SSMAW()
+{
+	if (compaction.joinable())
+		compaction.join();
 }
 
 //Indexing
-int LongestCommonPrefix(std::string entry, int startA, int startB)
+int LongestCommonPrefix(std::string_view entry, int startA, int startB)
 {
 	if (startA < startB)
 	{
@@ -53,7 +67,7 @@ int LongestCommonPrefix(std::string entry, int startA, int startB)
 	return result;
 }
 
-void TopDownPass(std::string entry, std::vector<int>& SA, std::vector<int>& LCP, std::vector<std::bitset<53>>& B1, std::vector<std::bitset<53>>& B2)
+void TopDownPass(std::string_view entry, std::vector<int>& SA, std::vector<int>& LCP, std::vector<std::bitset<53>>& B1, std::vector<std::bitset<53>>& B2)
 {
 	//Initialize interval array: saves all left neighbors of all factors sized <= max LCP
 	std::vector<std::bitset<53>> interval;
@@ -79,7 +93,7 @@ void TopDownPass(std::string entry, std::vector<int>& SA, std::vector<int>& LCP,
 		}
 		if (SA[i] > 0) //Index > 0 -> add left neighbor (Index 0 doesn't have left neighbour)
 		{
-			int ln = CharacterIndex(entry[SA[i] - 1]); //Left neighbour of suffix array
+			int ln = entry[SA[i] - 1]; //Left neighbour of suffix array
 			Node* current = LIFOLCP.Top();
 			while (current != nullptr && !interval[current->value][ln]) //Add left neighbor to all earlier encountered prefixes of suffix too
 			{															//When encounter already set to one, all smaller also already set, so stop
@@ -94,7 +108,7 @@ void TopDownPass(std::string entry, std::vector<int>& SA, std::vector<int>& LCP,
 		}
 		if (i > 0 && LCP[i] > 0 && SA[i - 1] > 0) //LCP with previous suffix array is > 0 and previous suffix array is not index 0 -> add its left neighbor to interval too
 		{
-			int ln = CharacterIndex(entry[SA[i - 1] - 1]);
+			int ln = entry[SA[i - 1] - 1];
 			interval[LCP[i]][ln] = 1;
 		}
 		B2[2 * i] = interval[LCP[i]]; //Add previously known left neighbors
@@ -103,7 +117,7 @@ void TopDownPass(std::string entry, std::vector<int>& SA, std::vector<int>& LCP,
 	}
 }
 
-void BottomUpPass(std::string entry, std::vector<int>& LCP, std::vector<std::bitset<53>>& B1, std::vector<std::bitset<53>>& B2)
+void BottomUpPass(std::string_view entry, std::vector<int>& LCP, std::vector<std::bitset<53>>& B1, std::vector<std::bitset<53>>& B2)
 {
 	//Initialize interval array: saves all left neighbors of all factors sized <= max LCP
 	std::vector<std::bitset<53>> interval;
@@ -161,7 +175,7 @@ void BottomUpPass(std::string entry, std::vector<int>& LCP, std::vector<std::bit
 	}
 }
 
-void CalculateArrays(std::string entry, std::vector<int>& SA, std::vector<int>& LCP, std::vector<std::bitset<53>>& B1, std::vector<std::bitset<53>>& B2)
+void CalculateArrays(std::string_view entry, std::vector<int>& SA, std::vector<int>& LCP, std::vector<std::bitset<53>>& B1, std::vector<std::bitset<53>>& B2)
 {
 	std::vector<Suffix> suffixes;
 	//Find suffixes
@@ -184,7 +198,7 @@ void CalculateArrays(std::string entry, std::vector<int>& SA, std::vector<int>&
 	BottomUpPass(entry, LCP, B1, B2); //Bottom up pass through arrays
 }
 
-void SSMAW::CalculateMAWs(std::string entry, std::vector<int>& SA, std::vector<int>& LCP,
+void SSMAW::CalculateMAWs(std::string_view entry, std::vector<int>& SA, std::vector<int>& LCP,
 	std::vector<std::bitset<53>>& B1, std::vector<std::bitset<53>>& B2, std::set<std::string>& MAWs)
 {
 	for (int j = 0; j < entry.size() * 2 - 1; j++)
@@ -198,12 +212,12 @@ void SSMAW::CalculateMAWs(std::string entry, std::vector<int>& SA, std::vector<i
 		{
 			if (difference[z])
 			{
-				char l = db->alphabet[z];
+				char l = (char)z; //Symbol index
 				int length = LCP[index + plus] + 2;
 				//Take MAWs of sizes between min and max
 				if (min <= length && length <= max)
 				{
-					std::string MAW = l + entry.substr(SA[index], LCP[index + plus] + 1);
+					std::string MAW = l + std::string(entry.substr(SA[index], LCP[index + plus] + 1));
 					MAWs.insert(MAW);
 				}
 			}
@@ -211,86 +225,561 @@ void SSMAW::CalculateMAWs(std::string entry, std::vector<int>& SA, std::vector<i
 	}
 }
 
+void SSMAW::ComputeMAWs(std::string_view entry, std::set<std::string>& MAWs)
+{
+	//Calculate all arrays
+	std::vector<int> SA; //Suffix array
+	std::vector<int> LCP; //Longest common prefix array
+	std::vector<std::bitset<53>> B1(entry.size() * 2, std::bitset<53>()); //TODO: allow for variable alphabet size
+	std::vector<std::bitset<53>> B2(entry.size() * 2, std::bitset<53>()); //TODO: allow for variable alphabet size
+	CalculateArrays(entry, SA, LCP, B1, B2);
+	//Calculate MAWs
+	CalculateMAWs(entry, SA, LCP, B1, B2, MAWs);
+}
+
 void SSMAW::Indexing()
 {
-	MAWcounts = std::vector<int>(db->db.size(), 0);
+	MAWcounts = std::vector<int>(db->Size(), 0);
+	removed = std::vector<bool>(db->Size(), false);
+	signatures.Resize(db->Size());
+	int nrOfChunks = (db->Size() + INDEXCHUNK - 1) / INDEXCHUNK;
 #pragma omp parallel for
-	for (int i = 0; i < db->db.size(); i++)
+	for (int c = 0; c < nrOfChunks; c++)
 	{
-		std::string entry = db->db[i].sequence;
-		//Calculate all arrays
-		std::vector<int> SA; //Suffix array
-		std::vector<int> LCP; //Longest common prefix array
-		std::vector<std::bitset<53>> B1(entry.size() * 2, std::bitset<53>()); //TODO: allow for variable alphabet size
-		std::vector<std::bitset<53>> B2(entry.size() * 2, std::bitset<53>()); //TODO: allow for variable alphabet size
-		CalculateArrays(entry, SA, LCP, B1, B2);
-		//Calculate MAWs
-		std::set<std::string> MAWs;
-		CalculateMAWs(entry, SA, LCP, B1, B2, MAWs);
+		//Stages timed per chunk of entries: the trace shows the load balance of the threads and the waits for the trie,
+		//spans per entry would overflow the ring buffers of the metrics on large databases
+		int first = c * INDEXCHUNK;
+		int size = std::min(INDEXCHUNK, db->Size() - first);
+		Span span(Name(), Metrics::SUFFIXARRAY);
+		std::vector<std::vector<int>> SA(size);
+		std::vector<std::vector<int>> LCP(size);
+		std::vector<std::vector<std::bitset<53>>> B1(size);
+		std::vector<std::vector<std::bitset<53>>> B2(size);
+		for (int j = 0; j < size; j++)
+		{
+			std::string_view entry = db->Sequence(db->Get(first + j));
+			B1[j] = std::vector<std::bitset<53>>(entry.size() * 2, std::bitset<53>());
+			B2[j] = std::vector<std::bitset<53>>(entry.size() * 2, std::bitset<53>());
+			CalculateArrays(entry, SA[j], LCP[j], B1[j], B2[j]);
+		}
+		span.Next(Metrics::MAWS);
+		std::vector<std::set<std::string>> MAWs(size);
+		for (int j = 0; j < size; j++)
+			CalculateMAWs(db->Sequence(db->Get(first + j)), SA[j], LCP[j], B1[j], B2[j], MAWs[j]);
 		//Save number of MAWs for each database entry
-		MAWcounts[i] = MAWs.size();
+		span.Next(Metrics::FREQUENCIES);
+		for (int j = 0; j < size; j++)
+		{
+			MAWcounts[first + j] = MAWs[j].size();
+			signatures.SetEntry(first + j, MAWs[j]);
+		}
 		//Build Trie for MAWs for quick search
+		span.Next(Metrics::TRIEINSERT);
 #pragma omp critical
 		{
-			for (std::string w : MAWs)
-				MAWsTrie.Insert(w, i);
+			for (int j = 0; j < size; j++)
+				for (const std::string& w : MAWs[j])
+					MAWsTrie.Insert(w, first + j);
 		}
 	}
+	live.resize(db->Size());
+	for (int i = 0; i < db->Size(); i++)
+		live[i] = i;
+	//Compress posting lists
+	Span span(Name(), Metrics::POSTINGS);
+	MAWsTrie.Compress();
+	signatures.BuildBuckets();
+}
+
+//Storage
+bool SSMAW::Save(std::string name)
+{
+	//Delta segments are merged first, so all posting lists are stored compressed
+	Compact();
+	std::shared_lock<std::shared_mutex> lock(indexMutex);
+	BinaryWriter writer(name, SSMAWMAGIC, SSMAWVERSION, db->Checksum(), { min, max, signatures.Bands(), signatures.Rows() });
+	writer.WriteVector(MAWcounts);
+	writer.WriteVector(std::vector<uint8_t>(removed.begin(), removed.end()));
+	writer.Write<uint32_t>(addedIDs.size());
+	for (int i = 0; i < addedIDs.size(); i++)
+	{
+		writer.WriteString(addedIDs[i]);
+		writer.WriteString(addedSequences[i]);
+	}
+	MAWsTrie.Write(writer);
+	signatures.Write(writer);
+	return writer.Close();
+}
+
+MemoryReport SSMAW::Memory()
+{
+	MemoryReport report = SimilaritySearch::Memory();
+	std::shared_lock<std::shared_mutex> lock(indexMutex);
+	MAWsTrie.Memory(report);
+	signatures.Memory(report);
+	report.Add("MAWcounts", HeapBytes(MAWcounts));
+	report.Add("Removed entries", HeapBytes(removed));
+	report.Add("Live entries", HeapBytes(live));
+	report.Add("Added entries", arenaBytes + HeapBytes(addedIDs) + HeapBytes(addedSequences) + HeapBytes(addedIndex));
+	return report;
+}
+
+bool SSMAW::Load(std::string name)
+{
+	BinaryReader reader(name, SSMAWMAGIC, SSMAWVERSION, db->Checksum(), { min, max, signatures.Bands(), signatures.Rows() });
+	if (!reader.Good())
+		return false;
+	std::vector<uint8_t> tombstones;
+	reader.ReadVector(MAWcounts);
+	reader.ReadVector(tombstones);
+	uint32_t added = reader.Read<uint32_t>();
+	for (uint32_t i = 0; i < added && reader.Good(); i++)
+	{
+		std::string_view id = reader.ReadString();
+		Added(id, reader.ReadString(), db->Size() + i);
+	}
+	MAWsTrie.Read(reader);
+	signatures.Read(reader);
+	if (!reader.Good() || MAWcounts.size() != db->Size() + added || tombstones.size() != MAWcounts.size())
+	{
+		blocks.clear();
+		blockUsed = BLOCKSIZE;
+		arenaBytes = 0;
+		addedIDs.clear();
+		addedSequences.clear();
+		addedIndex.clear();
+		MAWcounts.clear();
+		MAWsTrie.Clear();
+		signatures = MinHash(signatures.Bands(), signatures.Rows());
+		return false;
+	}
+	removed = std::vector<bool>(tombstones.begin(), tombstones.end());
+	LiveEntries();
+	return true;
+}
+
+void SSMAW::LiveEntries()
+{
+	live.clear();
+	for (int i = 0; i < removed.size(); i++)
+		if (!removed[i])
+			live.push_back(i);
 }
 
 //Searching
-std::vector<Result> SSMAW::SearchSequence(std::string query)
+void SSMAW::SetProbeBands(int probeBands)
 {
-#pragma region Initialization
-	std::clock_t start = std::clock();
-	//Calculate all arrays
-	std::vector<int> SA; //Suffix array
-	std::vector<int> LCP; //Longest common prefix array
-	std::vector<std::bitset<53>> B1(query.size() * 2, std::bitset<53>()); //TODO: allow for variable alphabet size
-	std::vector<std::bitset<53>> B2(query.size() * 2, std::bitset<53>()); //TODO: allow for variable alphabet size
-	CalculateArrays(query, SA, LCP, B1, B2);
-	//Calculate MAWs
-	std::set<std::string> MAWs;
-	CalculateMAWs(query, SA, LCP, B1, B2, MAWs);
-	double duration = (std::clock() - start) / (CLOCKS_PER_SEC / 1000);
-	std::cout << duration << ";"; //Indexing query
-#pragma endregion
+	//Number of LSH bands a query probes: 0 = exact search, more bands = higher recall but more candidates to rescore
+	this->probeBands = std::min(probeBands, signatures.Bands());
+}
 
-#pragma region Searching
-	start = std::clock();
-	//Calculate scores = number of common MAWs between query and database entry
-	auto it = MAWs.begin();
-	std::vector<int> score = std::vector<int>(db->db.size(), 0);
-	while (it != MAWs.end())
+double Jaccard(int intersect, int count, int nrOfMAWs)
+{
+	return (double)intersect / (double)(count + nrOfMAWs - intersect);
+}
+
+bool ComparePostings(const PostingList* i, const PostingList* j)
+{
+	return (i->Size() < j->Size());
+}
+
+//Per thread scratch of ExactScores, reused by every query: an entry's values belong to the current query only if its stamp is the current epoch,
+//so nothing has to be allocated or cleared per query and the work depends on the candidates, not on the database size
+struct ScoreBuffer
+{
+	std::vector<int> score; //Common MAWs so far
+	std::vector<uint32_t> stamp; //Epoch of score
+	std::vector<uint32_t> best; //Epoch in which the entry is one of the k best
+	std::vector<int> bestScore; //Score of its newest heap element
+	uint32_t epoch = 0;
+	void Start(int size)
+	{
+		if (score.size() < size)
+		{
+			score.resize(size);
+			stamp.resize(size, 0);
+			best.resize(size, 0);
+			bestScore.resize(size);
+		}
+		if (++epoch == 0) //Wrapped around: old stamps could look current
+		{
+			std::fill(stamp.begin(), stamp.end(), 0);
+			std::fill(best.begin(), best.end(), 0);
+			epoch = 1;
+		}
+	}
+	int Get(int id) const { return stamp[id] == epoch ? score[id] : 0; }
+	int& At(int id)
+	{
+		if (stamp[id] != epoch)
+		{
+			stamp[id] = epoch;
+			score[id] = 0;
+		}
+		return score[id];
+	}
+};
+
+static thread_local ScoreBuffer scoreBuffer;
+
+struct Bound
+{
+	double jaccard;
+	int score;
+	int id;
+	bool operator>(const Bound& other) const { return jaccard > other.jaccard; }
+};
+
+//Running k-th best Jaccard index of the admitted candidates: a min heap of the k best, updated whenever a score grows.
+//An entry whose score grows while in the heap gets a new element, the old one is skipped once it reaches the top (lazy deletion)
+class KthBest
+{
+private:
+	//Variables
+	int k;
+	int nrOfMAWs;
+	int size = 0; //Entries in the heap, without outdated elements
+	std::vector<Bound> heap;
+	ScoreBuffer& buffer;
+	const std::vector<int>& MAWcounts;
+	//Methods
+	bool Current(const Bound& bound) const { return buffer.best[bound.id] == buffer.epoch && buffer.bestScore[bound.id] == bound.score; }
+	void Push(int id, int score, double jaccard)
+	{
+		buffer.best[id] = buffer.epoch;
+		buffer.bestScore[id] = score;
+		heap.push_back({ jaccard, score, id });
+		std::push_heap(heap.begin(), heap.end(), std::greater<Bound>());
+	}
+	void Clean()
+	{
+		//Outdated elements on top are dropped, too many outdated elements -> rebuild
+		while (!Current(heap.front()))
+		{
+			std::pop_heap(heap.begin(), heap.end(), std::greater<Bound>());
+			heap.pop_back();
+		}
+		if (heap.size() > 4 * k + 64)
+		{
+			heap.erase(std::remove_if(heap.begin(), heap.end(), [this](const Bound& bound) { return !Current(bound); }), heap.end());
+			std::make_heap(heap.begin(), heap.end(), std::greater<Bound>());
+		}
+	}
+public:
+	//Methods
+	KthBest(int k, int nrOfMAWs, ScoreBuffer& buffer, const std::vector<int>& MAWcounts) : buffer(buffer), MAWcounts(MAWcounts)
+	{
+		this->k = k;
+		this->nrOfMAWs = nrOfMAWs;
+	}
+	void Offer(int id, int score)
+	{
+		double jaccard = Jaccard(score, MAWcounts[id], nrOfMAWs);
+		if (buffer.best[id] == buffer.epoch)
+			Push(id, score, jaccard);
+		else if (size < k)
+		{
+			Push(id, score, jaccard);
+			size++;
+		}
+		else
+		{
+			Clean();
+			if (jaccard <= heap.front().jaccard)
+				return;
+			buffer.best[heap.front().id] = 0;
+			std::pop_heap(heap.begin(), heap.end(), std::greater<Bound>());
+			heap.pop_back();
+			Push(id, score, jaccard);
+		}
+	}
+	double Threshold()
+	{
+		//k-th best current Jaccard index, -1 with fewer than k candidates
+		if (size < k)
+			return -1;
+		Clean();
+		return heap.front().jaccard;
+	}
+};
+
+void SSMAW::ExactScores(std::set<std::string>& MAWs, int k, std::vector<int>& candidates, std::vector<int>& intersections)
+{
+	//Top-k scoring (MaxScore): process posting lists from rarest to most common MAW
+	int nrOfMAWs = MAWs.size();
+	std::vector<const PostingList*> lists;
+	for (std::string w : MAWs)
 	{
-		std::vector<int> indicesEntries = MAWsTrie.Search((*it));
-		for (int i = 0; i < indicesEntries.size(); i++)
+		const PostingList* postings = MAWsTrie.Search(w);
+		if (postings != nullptr && postings->Size() > 0)
+			lists.push_back(postings);
+	}
+	std::sort(lists.begin(), lists.end(), ComparePostings);
+	ScoreBuffer& score = scoreBuffer;
+	score.Start(MAWcounts.size());
+	KthBest kthBest(k, nrOfMAWs, score, MAWcounts); //Current scores are lower bounds, so the k-th best current Jaccard index is a lower bound for the final k-th best
+	double threshold = -1; //Lower bound on the Jaccard index of the k-th best candidate
+	bool admitting = true;
+	for (int l = 0; l < lists.size(); l++)
+	{
+		int remaining = lists.size() - l; //Number of lists left, including the current one
+		if (admitting)
 		{
-			score[indicesEntries[i]]++;
+			//Entries not seen yet share at most all remaining MAWs -> Jaccard <= remaining / nrOfMAWs
+			threshold = kthBest.Threshold();
+			if ((double)remaining / nrOfMAWs < threshold)
+			{
+				admitting = false;
+				std::sort(candidates.begin(), candidates.end());
+			}
 		}
-		it++;
+		if (admitting)
+		{
+			int previous = candidates.size();
+			lists[l]->Decode(candidates);
+			int next = previous;
+			for (int c = previous; c < candidates.size(); c++) //New candidates have a score of 0
+			{
+				int id = candidates[c];
+				int& s = score.At(id);
+				if (s == 0 && !removed[id])
+					candidates[next++] = id;
+				s++;
+				if (!removed[id])
+					kthBest.Offer(id, s);
+			}
+			candidates.resize(next);
+		}
+		else
+		{
+			//Drop candidates whose upper bound can't reach the k-th best, count the remaining list only for candidates
+			int next = 0;
+			for (int c = 0; c < candidates.size(); c++)
+			{
+				int id = candidates[c];
+				int best = std::min(score.Get(id) + remaining, MAWcounts[id]);
+				if (Jaccard(best, MAWcounts[id], nrOfMAWs) >= threshold)
+					candidates[next++] = id;
+			}
+			candidates.resize(next);
+			std::vector<int> counts(candidates.size(), 0);
+			lists[l]->Count(candidates, counts);
+			for (int c = 0; c < candidates.size(); c++)
+				score.At(candidates[c]) += counts[c];
+		}
+	}
+	//Fewer than k entries share a MAW -> fill up with entries without common MAWs, skipped entries are candidates or removed since the last compaction
+	for (int i = 0; i < live.size() && candidates.size() < k; i++)
+	{
+		int id = live[i];
+		if (score.Get(id) == 0 && !removed[id])
+			candidates.push_back(id);
 	}
-	duration = (std::clock() - start) / (CLOCKS_PER_SEC / 1000);
-	std::cout << duration << ";"; //Scoring
+	for (int c = 0; c < candidates.size(); c++)
+		intersections.push_back(score.Get(candidates[c]));
+}
+
+void SSMAW::ApproximateScores(std::set<std::string>& MAWs, std::vector<int>& candidates, std::vector<int>& intersections)
+{
+	//Candidates = LSH bucket collisions, only these are rescored exactly
+	signatures.Candidates(MAWs, probeBands, candidates);
+	int next = 0;
+	for (int c = 0; c < candidates.size(); c++)
+		if (!removed[candidates[c]])
+			candidates[next++] = candidates[c];
+	candidates.resize(next);
+	intersections = std::vector<int>(candidates.size(), 0);
+	for (std::string w : MAWs)
+	{
+		const PostingList* postings = MAWsTrie.Search(w);
+		if (postings != nullptr)
+			postings->Count(candidates, intersections);
+	}
+}
+
+std::vector<Result> SSMAW::SearchSequence(std::string_view query, int k)
+{
+#pragma region Initialization
+	Span span(Name(), Metrics::INDEXQUERY);
+	std::set<std::string> MAWs;
+	ComputeMAWs(query, MAWs);
+#pragma endregion
+
+#pragma region Searching
+	span.Next(Metrics::CANDIDATES);
+	std::shared_lock<std::shared_mutex> lock(indexMutex);
+	int nrOfMAWs = MAWs.size();
+	k = std::max(0, std::min(k, (int)MAWcounts.size()));
+	if (k == 0)
+		return std::vector<Result>();
+	std::vector<int> candidates;
+	std::vector<int> intersections; //Number of common MAWs with each candidate
+	if (probeBands > 0)
+		ApproximateScores(MAWs, candidates, intersections);
+	else
+		ExactScores(MAWs, k, candidates, intersections);
 
-	start = std::clock();
 	//Calculate results -> jaccard distance = 1-(intersect/union)
-	std::vector<Result> result(db->db.size());
-//#pragma omp parallel for
-	for (int i = 0; i < score.size(); i++)
+	span.Next(Metrics::SEARCH);
+	TopK top(k, true);
+	for (int c = 0; c < candidates.size(); c++)
 	{
-		double jaccard = (double)1 - ((double)score[i] / (double)(MAWcounts[i] + MAWs.size() - score[i]));
-		result[i] = Result(db->rIndex[i], jaccard, true); //TODO: Fix rIndex! If PassJoin sorts, rIndex is not correct (right now SSMAW first in testing order, so not a problem)
+		int id = candidates[c];
+		double jaccard = (double)1 - Jaccard(intersections[c], MAWcounts[id], nrOfMAWs);
+		top.Push(Result(id, jaccard, true));
 	}
-	duration = (std::clock() - start) / (CLOCKS_PER_SEC / 1000);
-	std::cout << duration << ";"; //Searching
 #pragma endregion
 
 #pragma region Sorting results
-	start = std::clock();
-	std::sort(result.rbegin(), result.rend());
-	duration = (std::clock() - start) / (CLOCKS_PER_SEC / 1000);
-	std::cout << duration << ";\n"; //Sorting
+	span.Next(Metrics::SORT);
+	std::vector<Result> result = top.Results();
 #pragma endregion
 	return result;
+}
+
+//Updating
+void SSMAW::AddEntry(std::string id, std::string sequence)
+{
+	//Only the MAWs of the new entry are calculated, its postings go to the delta segments of the posting lists
+	std::set<std::string> MAWs;
+	std::string encoded = db->Encode(sequence);
+	ComputeMAWs(encoded, MAWs);
+	bool compact;
+	{
+		std::unique_lock<std::shared_mutex> lock(indexMutex);
+		int entry = MAWcounts.size();
+		Added(id, encoded, entry);
+		MAWcounts.push_back(MAWs.size());
+		removed.push_back(false);
+		live.push_back(entry);
+		signatures.Insert(entry, MAWs);
+		for (std::string w : MAWs)
+			MAWsTrie.Append(w, entry);
+		pendingEntries++;
+		compact = (pendingEntries * 10 >= MAWcounts.size()); //Compact when the delta segments hold 10% of the entries
+	}
+	if (compact)
+		CompactAsync();
+}
+
+void SSMAW::RemoveEntry(std::string id)
+{
+	//Tombstone: the entry keeps its number (other indexes refer to database entries), its postings are dropped by the next compaction
+	std::unique_lock<std::shared_mutex> lock(indexMutex);
+	int entry = FindEntry(id);
+	if (entry < 0)
+		return;
+	if (!removed[entry])
+	{
+		removed[entry] = true;
+		removedEntries++;
+	}
+}
+
+void SSMAW::Compact()
+{
+	//Merge delta segments into the compressed posting lists, without blocking searches while merging
+	std::lock_guard<std::mutex> guard(compactionMutex);
+	std::vector<TrieNode*> nodes;
+	std::vector<PostingList> merged;
+	std::vector<int> consumed;
+	int pending;
+	int removals;
+	{
+		std::shared_lock<std::shared_mutex> lock(indexMutex);
+		pending = pendingEntries;
+		removals = removedEntries;
+		std::vector<TrieNode*> all;
+		MAWsTrie.Nodes(all);
+		for (TrieNode* node : all)
+		{
+			if (node->postings.Pending() > 0 || removals > 0) //Removed entries can be in any list
+			{
+				int c;
+				merged.push_back(node->postings.Merge(removed, c));
+				consumed.push_back(c);
+				nodes.push_back(node);
+			}
+		}
+	}
+	std::unique_lock<std::shared_mutex> lock(indexMutex);
+	for (int i = 0; i < nodes.size(); i++)
+		nodes[i]->postings.Replace(merged[i], consumed[i]);
+	if (removals > 0)
+		LiveEntries();
+	pendingEntries -= pending;
+	removedEntries -= removals;
+}
+
+std::string_view SSMAW::Store(std::string_view data)
+{
+	//Bump allocation, a new block when the current one is full. Larger data gets a block of its own
+	if (BLOCKSIZE - blockUsed < data.size())
+	{
+		size_t size = std::max(BLOCKSIZE, data.size());
+		blocks.push_back(std::unique_ptr<char[]>(new char[size]));
+		arenaBytes += size;
+		blockUsed = 0;
+	}
+	char* destination = blocks.back().get() + blockUsed;
+	std::copy(data.begin(), data.end(), destination);
+	blockUsed = std::min(blockUsed + data.size(), BLOCKSIZE); //A large block is full
+	return std::string_view(destination, data.size());
+}
+
+void SSMAW::Added(std::string_view id, std::string_view sequence, int entry)
+{
+	addedIDs.push_back(Store(id));
+	addedSequences.push_back(Store(sequence));
+	addedIndex.insert_or_assign(addedIDs.back(), entry);
+}
+
+int SSMAW::FindEntry(std::string_view id)
+{
+	auto added = addedIndex.find(id);
+	if (added != addedIndex.end())
+		return added->second;
+	return db->Find(id);
+}
+
+int SSMAW::Size()
+{
+	std::shared_lock<std::shared_mutex> lock(indexMutex);
+	return MAWcounts.size();
+}
+
+int SSMAW::Find(std::string_view id)
+{
+	std::shared_lock<std::shared_mutex> lock(indexMutex);
+	return FindEntry(id);
+}
+
+std::string_view SSMAW::ID(int entry)
+{
+	if (entry < db->Size())
+		return db->ID(entry);
+	std::shared_lock<std::shared_mutex> lock(indexMutex);
+	return addedIDs[entry - db->Size()];
+}
+
+std::string_view SSMAW::Sequence(int entry)
+{
+	if (entry < db->Size())
+		return db->Sequence(db->Get(entry));
+	std::shared_lock<std::shared_mutex> lock(indexMutex);
+	return addedSequences[entry - db->Size()];
+}
+
+void SSMAW::CompactAsync()
+{
+	//Compaction in a background thread, at most one at a time
+	if (compacting.exchange(true))
+		return;
+	if (compaction.joinable())
+		compaction.join();
+	compaction = std::thread([this]()
+		{
+			Compact();
+			compacting = false;
+		});
 }
\ No newline at end of file
@@ -5,7 +5,17 @@
 #pragma once
 #include "../General/SimilaritySearch.h"
 #include "Trie.h"
+#include "MinHash.h"
+#include <atomic>
+#include <bitset>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+
+void CalculateArrays(std::string_view entry, std::vector<int>& SA, std::vector<int>& LCP, std::vector<std::bitset<53>>& B1, std::vector<std::bitset<53>>& B2); //Suffix, LCP and left neighbour arrays, B1 and B2 hold 2 * |entry| elements
 
 class SSMAW : public SimilaritySearch
 {
@@ -13,16 +23,56 @@ private:
 	//Variables
 	int min;
 	int max;
-	int nrOfResults;
+	int probeBands = 0;
 	std::vector<int> MAWcounts;
+	std::vector<bool> removed; //Tombstones of removed entries
+	std::vector<int> live; //Entries not removed at the last compaction, fill up candidates of ExactScores
+	int pendingEntries = 0; //Entries added since the last compaction
+	int removedEntries = 0; //Entries removed since the last compaction
+	static const int INDEXCHUNK = 64; //Entries per indexing task, the stages are timed per task
 	Trie MAWsTrie = Trie();
+	MinHash signatures;
+	std::shared_mutex indexMutex; //Searches share the index, adding, removing and compaction swaps are exclusive
+	std::mutex compactionMutex;
+	std::thread compaction;
+	std::atomic<bool> compacting{ false };
+	//Entries added after indexing (entry numbers from db->Size() on) are owned by the index, the shared database is never modified
+	static const size_t BLOCKSIZE = 1 << 16;
+	std::vector<std::unique_ptr<char[]>> blocks; //Arena of the added IDs and sequences, blocks never move so views into them stay valid
+	size_t blockUsed = BLOCKSIZE;
+	size_t arenaBytes = 0;
+	std::vector<std::string_view> addedIDs;
+	std::vector<std::string_view> addedSequences; //Encoded as in the database
+	std::unordered_map<std::string_view, int> addedIndex; //ID -> entry number
 	//Methods
-	void CalculateMAWs(std::string entry, std::vector<int>& SA, std::vector<int>& LCP,
+	void ComputeMAWs(std::string_view entry, std::set<std::string>& MAWs);
+	void CalculateMAWs(std::string_view entry, std::vector<int>& SA, std::vector<int>& LCP,
 		std::vector<std::bitset<53>>& B1, std::vector<std::bitset<53>>& B2, std::set<std::string>& MAWs);
 	void Indexing();
+	bool Load(std::string name);
+	void LiveEntries();
+	std::string_view Store(std::string_view data);
+	void Added(std::string_view id, std::string_view sequence, int entry);
+	int FindEntry(std::string_view id);
+	void ExactScores(std::set<std::string>& MAWs, int k, std::vector<int>& candidates, std::vector<int>& intersections);
+	void ApproximateScores(std::set<std::string>& MAWs, std::vector<int>& candidates, std::vector<int>& intersections);
 public:
 	SSMAW() {};
-	SSMAW(Database* db, int min, int max, int nrOfResults);
-	std::vector<Result> SearchSequence(std::string query) override;
+	SSMAW(const Database* db, int min, int max, int bands = 0, int rows = 0, std::string indexFile = ""); //Index is loaded from indexFile if it matches, otherwise built and saved there
+	~SSMAW();
+	const char* Name() override { return "SSMAW"; }
+	std::vector<Result> SearchSequence(std::string_view query, int k) override;
+	MemoryReport Memory() override;
+	void SetProbeBands(int probeBands);
+	void AddEntry(std::string id, std::string sequence);
+	void RemoveEntry(std::string id);
+	//Entries of the database and the added entries
+	int Size();
+	int Find(std::string_view id); //Entry number of the ID, -1 if not present. Added entries shadow database entries with the same ID
+	std::string_view ID(int entry);
+	std::string_view Sequence(int entry); //Encoded
+	void Compact();
+	void CompactAsync();
+	bool Save(std::string name);
 	int indexTime;
 };
\ No newline at end of file
@@ -3,14 +3,14 @@
 */
 
 #pragma once
-#include <string>
+#include <string_view>
 
 struct Suffix
 {
-	std::string suffix;
+	std::string_view suffix;
 	int pos;
 	Suffix() {};
-	Suffix(std::string suffix, int pos)
+	Suffix(std::string_view suffix, int pos)
 	{
 		this->suffix = suffix;
 		this->pos = pos;
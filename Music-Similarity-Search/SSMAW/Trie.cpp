@@ -3,6 +3,7 @@
 */
 
 #include "Trie.h"
+#include <algorithm>
 struct TrieNode* makeNode()
 {
 	struct TrieNode* node = new TrieNode;
@@ -35,4 +36,72 @@ void TrieDestructor(TrieNode* node)
 		delete(node);
 		return;
 	}
+}
+
+void TrieCompress(TrieNode* node)
+{
+	//Sort entries of every node and move them into a compressed posting list
+	if (node != nullptr)
+	{
+		if (!node->entries.empty())
+		{
+			std::sort(node->entries.begin(), node->entries.end());
+			node->postings.Encode(node->entries);
+			std::vector<int>().swap(node->entries);
+		}
+		for (TrieNode* child : node->children)
+			TrieCompress(child);
+	}
+}
+
+void TrieNodes(TrieNode* node, std::vector<TrieNode*>& nodes)
+{
+	//Collect all nodes with postings
+	if (node != nullptr)
+	{
+		if (node->postings.Size() > 0)
+			nodes.push_back(node);
+		for (TrieNode* child : node->children)
+			TrieNodes(child, nodes);
+	}
+}
+
+void TrieWrite(TrieNode* node, BinaryWriter& writer)
+{
+	//Pre-order: mask of the existing children, postings, children
+	uint64_t mask = 0;
+	for (int i = 0; i < 53; i++)
+		if (node->children[i] != NULL)
+			mask |= (uint64_t)1 << i;
+	writer.Write(mask);
+	node->postings.Write(writer);
+	for (TrieNode* child : node->children)
+		if (child != nullptr)
+			TrieWrite(child, writer);
+}
+
+void TrieRead(TrieNode* node, BinaryReader& reader)
+{
+	uint64_t mask = reader.Read<uint64_t>();
+	node->postings.Read(reader);
+	for (int i = 0; i < 53 && reader.Good(); i++)
+	{
+		if (mask & ((uint64_t)1 << i))
+		{
+			node->children[i] = makeNode();
+			TrieRead(node->children[i], reader);
+		}
+	}
+}
+
+void TrieMemory(TrieNode* node, long long& nodes, long long& postings, long long& building)
+{
+	if (node != nullptr)
+	{
+		nodes++;
+		postings += node->postings.Bytes();
+		building += HeapBytes(node->entries);
+		for (TrieNode* child : node->children)
+			TrieMemory(child, nodes, postings, building);
+	}
 }
\ No newline at end of file
@@ -3,7 +3,8 @@
 */
 
 #pragma once
-#include "../General/Scoring.h"
+#include "PostingList.h"
+#include "../General/Memory.h"
 #include <bitset>
 #include <vector>
 
@@ -13,13 +14,24 @@
 struct TrieNode
 {
 	struct TrieNode* children[53];
-	std::vector<int> entries;
+	std::vector<int> entries; //Only used while building, moved into postings by Compress
+	PostingList postings;
 };
 
 struct TrieNode* makeNode();
 
 void TrieDestructor(TrieNode* node);
 
+void TrieCompress(TrieNode* node);
+
+void TrieNodes(TrieNode* node, std::vector<TrieNode*>& nodes);
+
+void TrieWrite(TrieNode* node, BinaryWriter& writer);
+
+void TrieRead(TrieNode* node, BinaryReader& reader);
+
+void TrieMemory(TrieNode* node, long long& nodes, long long& postings, long long& building);
+
 class Trie
 {
 private:
@@ -39,27 +51,69 @@ public:
 		struct TrieNode* current = root;
 		for (int i = 0; i < word.length(); i++)
 		{
-			int index = CharacterIndex(word[i]);
+			int index = word[i]; //Symbol index
 			if (current->children[index] == NULL)
 				current->children[index] = makeNode();
 			current = current->children[index];
 		}
 		current->entries.push_back(entry);
 	}
-	std::vector<int> Search(std::string word)
+	void Append(std::string word, int entry)
+	{
+		//Incremental insert after compression: entry is larger than all indexed entries
+		struct TrieNode* current = root;
+		for (int i = 0; i < word.length(); i++)
+		{
+			int index = word[i]; //Symbol index
+			if (current->children[index] == NULL)
+				current->children[index] = makeNode();
+			current = current->children[index];
+		}
+		current->postings.Append(entry);
+	}
+	void Compress()
+	{
+		TrieCompress(root);
+	}
+	void Nodes(std::vector<TrieNode*>& nodes)
+	{
+		TrieNodes(root, nodes);
+	}
+	void Write(BinaryWriter& writer)
+	{
+		TrieWrite(root, writer);
+	}
+	void Read(BinaryReader& reader)
+	{
+		TrieRead(root, reader);
+	}
+	void Memory(MemoryReport& report)
+	{
+		long long nodes = 0;
+		long long postings = 0;
+		long long building = 0;
+		TrieMemory(root, nodes, postings, building);
+		report.Add("MAW trie nodes", nodes * sizeof(TrieNode));
+		report.Add("MAW posting lists", postings);
+		if (building > 0)
+			report.Add("MAW trie entries (uncompressed)", building);
+	}
+	void Clear()
+	{
+		TrieDestructor(root);
+		this->root = makeNode();
+	}
+	const PostingList* Search(std::string word)
 	{
 		TrieNode* current = root;
 		for(int i = 0; i < word.length(); i++)
 		{
-			int index = CharacterIndex(word[i]);
+			int index = word[i]; //Symbol index
 			if (!current->children[index])
-				return std::vector<int>();
+				return nullptr;
 			current = current->children[index];
 		}
-		if (current != NULL)
-			return current->entries;
-		else
-			return std::vector<int>();
+		return &current->postings;
 	}
 };
 